@@ -0,0 +1,412 @@
+/**
+ * \file benchmarks.c
+ * \brief This file contains the benchmarks of the lfsr and pnm libraries (parse, keystream, encryption and write).
+ * \author Gardier Simon
+ * \date 26.10.2023
+ * \version: V2
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
+#include "../pnm/pnm.h"
+#include "../lfsr/lfsr.h"
+
+/**
+ * \def DEFAULT_RUNS
+ * @brief The default number of times each benchmark is run.
+ */
+#define DEFAULT_RUNS 5
+
+/**
+ * \def MAX_RUNS
+ * @brief The maximum number of times a benchmark can be run.
+ */
+#define MAX_RUNS 100
+
+/**
+ * \def LFSR_STEPS
+ * @brief The number of operations timed for each register length.
+ */
+#define LFSR_STEPS (1 << 20)
+
+/**
+ * \def INPUT_NAMES
+ * @brief The synthetic images, indexed by MAGIC_NUMBERS (P1 to P3), written in the current directory.
+ */
+static char *INPUT_NAMES[3] = {"bench_input.pbm", "bench_input.pgm", "bench_input.ppm"};
+
+/**
+ * \def OUTPUT_NAMES
+ * @brief The encrypted images, indexed by MAGIC_NUMBERS (P1 to P3), written in the current directory.
+ */
+static char *OUTPUT_NAMES[3] = {"bench_output.pbm", "bench_output.pgm", "bench_output.ppm"};
+
+/**
+ * \struct REPORT_t
+ * \brief  The outputs of the benchmarks.
+ */
+typedef struct REPORT_t
+{
+    FILE *human;        /*!< The human readable table. */
+    FILE *json;         /*!< The JSON array, NULL if not requested. */
+    unsigned int runs;  /*!< The number of runs of each benchmark. */
+    unsigned int count; /*!< The number of results written in json. */
+} REPORT;
+
+/**
+ * \fn static double now(void)
+ * \brief Get the time of a monotonic clock.
+ *
+ * \return double The time in seconds.
+ */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+} // end now()
+
+/**
+ * \fn static int compare_doubles(const void *first, const void *second)
+ * \brief Order doubles increasingly, for qsort().
+ */
+static int compare_doubles(const void *first, const void *second)
+{
+    double a = *(const double *)first;
+    double b = *(const double *)second;
+    return (a > b) - (a < b);
+} // end compare_doubles()
+
+/**
+ * \fn static void report(REPORT *report, char *stage, char *subject, double bytes, double units, char *unit, double *seconds)
+ * \brief Write the result of a benchmark (median time, throughput and spread of the runs).
+ *
+ * \param report The outputs.
+ * \param stage The function timed.
+ * \param subject The input of the function (image format and size, register length).
+ * \param bytes The number of bytes handled by a run, for the MB/s.
+ * \param units The number of units (samples, bits, words) handled by a run, for the ns/unit.
+ * \param unit The name of the unit.
+ * \param seconds The duration of each run, sorted by the function.
+ *
+ * \pre report is instanced, seconds holds report->runs durations.
+ * \post The result is written in the human table and in the JSON array.
+ */
+static void report_result(REPORT *report, char *stage, char *subject, double bytes, double units, char *unit, double *seconds)
+{
+    unsigned int runs = report->runs;
+    qsort(seconds, runs, sizeof(double), compare_doubles);
+    double median = runs % 2 ? seconds[runs / 2] : (seconds[runs / 2 - 1] + seconds[runs / 2]) / 2;
+    double spread = median > 0 ? (seconds[runs - 1] - seconds[0]) / median * 100 : 0;
+    double megabytesPerSecond = median > 0 ? bytes / median / 1e6 : 0;
+    double nanosecondsPerUnit = units > 0 ? median / units * 1e9 : 0;
+
+    fprintf(report->human, "%-20s %-18s %12.2f MB/s %12.2f ns/%-7s median %10.3f ms  spread %6.1f %%\n",
+            stage, subject, megabytesPerSecond, nanosecondsPerUnit, unit, median * 1e3, spread);
+    fflush(report->human);
+
+    if (report->json)
+    {
+        fprintf(report->json, "%s\n  {\"stage\": \"%s\", \"subject\": \"%s\", \"runs\": %u, \"bytes\": %.0f, \"units\": %.0f, \"unit\": \"%s\", "
+                              "\"median_s\": %.9f, \"min_s\": %.9f, \"max_s\": %.9f, \"spread_percent\": %.2f, \"mb_per_s\": %.3f, \"ns_per_unit\": %.3f}",
+                report->count ? "," : "[", stage, subject, runs, bytes, units, unit,
+                median, seconds[0], seconds[runs - 1], spread, megabytesPerSecond, nanosecondsPerUnit);
+        report->count++;
+    }
+} // end report_result()
+
+/**
+ * \fn static double file_size(char *filename)
+ * \brief Get the size of a file.
+ *
+ * \param filename The path of the file.
+ *
+ * \return double The size in bytes, 0 if the file is missing.
+ */
+static double file_size(char *filename)
+{
+    struct stat fileStatus;
+    return stat(filename, &fileStatus) == 0 ? (double)fileStatus.st_size : 0;
+} // end file_size()
+
+/**
+ * \fn static int create_image(MAGIC_NUMBERS magicNumber, unsigned int columns, unsigned int lines)
+ * \brief Write a synthetic ASCII image of random samples (max color value 255).
+ *
+ * \param magicNumber The format (P1, P2 or P3).
+ * \param columns The number of columns.
+ * \param lines The number of lines.
+ *
+ * \pre magicNumber is P1, P2 or P3.
+ * \post The image is written in INPUT_NAMES[magicNumber].
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int create_image(MAGIC_NUMBERS magicNumber, unsigned int columns, unsigned int lines)
+{
+    FILE *image = fopen(INPUT_NAMES[magicNumber], "w");
+    if (!image)
+    {
+        return 0;
+    }
+    unsigned int samples = magicNumber == P3 ? columns * 3 : columns;
+    unsigned int maxValue = magicNumber == P1 ? 1 : 255;
+
+    fprintf(image, "P%d\n# synthetic image\n%u %u\n", magicNumber + 1, columns, lines);
+    if (magicNumber != P1)
+    {
+        fprintf(image, "%u\n", maxValue);
+    }
+    for (unsigned int i = 0; i < lines; i++)
+    {
+        for (unsigned int j = 0; j < samples; j++)
+        {
+            fprintf(image, "%u ", (unsigned int)rand() % (maxValue + 1));
+        }
+        fputc('\n', image);
+    }
+    return fclose(image) == 0;
+} // end create_image()
+
+/**
+ * \fn static void bench_image(REPORT *report, MAGIC_NUMBERS magicNumber, unsigned int columns, unsigned int lines)
+ * \brief Time load_pnm(), pnm_file_encryption() and write_pnm() on a synthetic image.
+ *
+ * \param report The outputs.
+ * \param magicNumber The format (P1, P2 or P3).
+ * \param columns The number of columns.
+ * \param lines The number of lines.
+ *
+ * \pre report is instanced, magicNumber is P1, P2 or P3.
+ * \post The results are reported, the images are removed.
+ */
+static void bench_image(REPORT *report, MAGIC_NUMBERS magicNumber, unsigned int columns, unsigned int lines)
+{
+    double load[MAX_RUNS];
+    double encryption[MAX_RUNS];
+    double write[MAX_RUNS];
+    char subject[64];
+    snprintf(subject, sizeof(subject), "P%d %ux%u", magicNumber + 1, columns, lines);
+    if (!create_image(magicNumber, columns, lines))
+    {
+        fprintf(report->human, "%-20s %-18s unable to write the image\n", "load_pnm", subject);
+        return;
+    }
+
+    for (unsigned int r = 0; r < report->runs; r++)
+    {
+        PNM *image;
+        LFSR *lfsr = create_lfsr("0110100001011101", 5);
+        double start = now();
+        if (load_pnm(&image, INPUT_NAMES[magicNumber]) != 0)
+        {
+            fprintf(report->human, "%-20s %-18s unable to load the image\n", "load_pnm", subject);
+            free_lfsr(&lfsr);
+            remove(INPUT_NAMES[magicNumber]);
+            return;
+        }
+        double loaded = now();
+        pnm_file_encryption(image, lfsr);
+        double encrypted = now();
+        write_pnm(image, OUTPUT_NAMES[magicNumber]);
+        double written = now();
+
+        load[r] = loaded - start;
+        encryption[r] = encrypted - loaded;
+        write[r] = written - encrypted;
+        free_pnm(&image);
+        free_lfsr(&lfsr);
+    }
+
+    double samples = (double)columns * lines * (magicNumber == P3 ? 3 : 1);
+    report_result(report, "load_pnm", subject, file_size(INPUT_NAMES[magicNumber]), samples, "sample", load);
+    report_result(report, "pnm_file_encryption", subject, file_size(INPUT_NAMES[magicNumber]), samples, "sample", encryption);
+    report_result(report, "write_pnm", subject, file_size(OUTPUT_NAMES[magicNumber]), samples, "sample", write);
+    remove(INPUT_NAMES[magicNumber]);
+    remove(OUTPUT_NAMES[magicNumber]);
+} // end bench_image()
+
+/**
+ * \fn static void bench_lfsr(REPORT *report, unsigned int length)
+ * \brief Time operation(), generation() and lfsr_fill() on a random register, and the same on its Galois and ring forms.
+ *
+ * \param report The outputs.
+ * \param length The length of the register.
+ *
+ * \pre report is instanced, length > 0.
+ * \post The results are reported.
+ */
+static void bench_lfsr(REPORT *report, unsigned int length)
+{
+    double operations[MAX_RUNS];
+    double generations[MAX_RUNS];
+    double fills[MAX_RUNS];
+    double galoisOperations[MAX_RUNS];
+    double galoisFills[MAX_RUNS];
+    double ringOperations[MAX_RUNS];
+    double ringFills[MAX_RUNS];
+    char subject[64];
+    snprintf(subject, sizeof(subject), "%u bits register", length);
+
+    char *seed = malloc(length + 1);
+    uint32_t *words = malloc(LFSR_STEPS / 32 * sizeof(uint32_t));
+    if (!seed || !words)
+    {
+        fprintf(report->human, "%-20s %-18s unable to allocate the register\n", "operation", subject);
+        free(seed);
+        free(words);
+        return;
+    }
+    for (unsigned int i = 0; i < length; i++)
+    {
+        seed[i] = (char)('0' + rand() % 2);
+    }
+    seed[length] = '\0';
+
+    // a sink keeps the results alive
+    volatile unsigned int sink = 0;
+    for (unsigned int r = 0; r < report->runs; r++)
+    {
+        LFSR *lfsr = create_lfsr(seed, (int)(length / 3));
+        double start = now();
+        for (unsigned int k = 0; k < LFSR_STEPS; k++)
+        {
+            sink ^= operation(lfsr);
+        }
+        double operated = now();
+        for (unsigned int k = 0; k < LFSR_STEPS / 32; k++)
+        {
+            sink ^= generation(lfsr, 32);
+        }
+        double generated = now();
+        lfsr_fill(lfsr, words, LFSR_STEPS / 32);
+        double filled = now();
+        sink ^= words[0];
+
+        operations[r] = operated - start;
+        generations[r] = generated - operated;
+        fills[r] = filled - generated;
+
+        GALOIS_LFSR *galois = create_galois_lfsr(lfsr);
+        start = now();
+        for (unsigned int k = 0; k < LFSR_STEPS; k++)
+        {
+            sink ^= galois_operation(galois);
+        }
+        operated = now();
+        galois_fill(galois, words, LFSR_STEPS / 32);
+        filled = now();
+        sink ^= words[0];
+
+        galoisOperations[r] = operated - start;
+        galoisFills[r] = filled - operated;
+        free_galois_lfsr(&galois);
+
+        RING_LFSR *ring = create_ring_lfsr(lfsr);
+        start = now();
+        for (unsigned int k = 0; k < LFSR_STEPS; k++)
+        {
+            sink ^= ring_operation(ring);
+        }
+        operated = now();
+        ring_fill(ring, words, LFSR_STEPS / 32);
+        filled = now();
+        sink ^= words[0];
+
+        ringOperations[r] = operated - start;
+        ringFills[r] = filled - operated;
+        free_ring_lfsr(&ring);
+        free_lfsr(&lfsr);
+    }
+
+    report_result(report, "operation", subject, LFSR_STEPS / 8, LFSR_STEPS, "bit", operations);
+    report_result(report, "generation(32)", subject, LFSR_STEPS / 8, LFSR_STEPS / 32, "word", generations);
+    report_result(report, "lfsr_fill", subject, LFSR_STEPS / 8, LFSR_STEPS / 32, "word", fills);
+    report_result(report, "galois_operation", subject, LFSR_STEPS / 8, LFSR_STEPS, "bit", galoisOperations);
+    report_result(report, "galois_fill", subject, LFSR_STEPS / 8, LFSR_STEPS / 32, "word", galoisFills);
+    report_result(report, "ring_operation", subject, LFSR_STEPS / 8, LFSR_STEPS, "bit", ringOperations);
+    report_result(report, "ring_fill", subject, LFSR_STEPS / 8, LFSR_STEPS / 32, "word", ringFills);
+    free(seed);
+    free(words);
+} // end bench_lfsr()
+
+int main(int argc, char *argv[])
+{
+    int val;
+    char *jsonPath = NULL;
+    int runs = DEFAULT_RUNS;
+
+    while ((val = getopt(argc, argv, ":r:o:")) != -1)
+    {
+        switch (val)
+        {
+        case 'r':
+            if (sscanf(optarg, "%d", &runs) != 1 || runs < 1 || runs > MAX_RUNS)
+            {
+                printf("> 🔴 The number of runs [%s] should be in [1, %d].\n", optarg, MAX_RUNS);
+                return 1;
+            }
+            break;
+
+        case 'o':
+            jsonPath = optarg;
+            break;
+
+        default:
+            printf("> 🔴 Usage : ./benchmarks [-r runs] [-o jsonFilePath]\n");
+            return 1;
+        }
+    }
+
+    // Step 1 : the table goes to the terminal, the messages of the libraries are dropped
+    REPORT report;
+    report.runs = (unsigned int)runs;
+    report.count = 0;
+    report.json = NULL;
+    int console = dup(STDOUT_FILENO);
+    if (console < 0 || !(report.human = fdopen(console, "w")) || !freopen("/dev/null", "w", stdout))
+    {
+        printf("> 🔴 Unable to redirect the standard output.\n");
+        return 1;
+    }
+    if (jsonPath && !(report.json = fopen(jsonPath, "w")))
+    {
+        fprintf(report.human, "> 🔴 Unable to open the file [%s].\n", jsonPath);
+        return 1;
+    } // end Step 1
+
+    // Step 2 : registers of several lengths
+    unsigned int lengths[6] = {6, 16, 64, 128, 256, 600};
+    srand(42);
+    fprintf(report.human, "Median of %d runs, MB/s of keystream (lfsr) or of the file handled (pnm)\n\n", runs);
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        bench_lfsr(&report, lengths[i]);
+    } // end Step 2
+
+    // Step 3 : synthetic images of several formats and sizes
+    unsigned int sizes[3] = {128, 512, 1024};
+    for (unsigned int magicNumber = P1; magicNumber <= P3; magicNumber++)
+    {
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            bench_image(&report, (MAGIC_NUMBERS)magicNumber, sizes[i], sizes[i]);
+        }
+    } // end Step 3
+
+    if (report.json)
+    {
+        fprintf(report.json, "%s\n", report.count ? "\n]" : "[]");
+        fclose(report.json);
+    }
+    fclose(report.human);
+    return 0;
+} // end main()
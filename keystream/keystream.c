@@ -0,0 +1,681 @@
+/**
+ * \file keystream.c
+ * \brief This file contains the KEYSTREAM type definition and the functions of the on-disk cache of lfsr keystreams.
+ * \author Gardier Simon
+ * \date 26.10.2023
+ * \version: V2
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "keystream.h"
+#include "../utils/utils.h"
+
+/**
+ * \def KEYSTREAM_MAGIC
+ * @brief The first bytes of a cache entry (format version included).
+ */
+#define KEYSTREAM_MAGIC "LFSRKS3"
+
+/**
+ * \def KEYSTREAM_EXTENSION
+ * @brief The extension of the cache entries, the other files of the directory are ignored.
+ */
+#define KEYSTREAM_EXTENSION ".ks"
+
+/**
+ * \def KEYSTREAM_SALT
+ * @brief The file of the cache directory holding its secret salt, hidden from the eviction.
+ */
+#define KEYSTREAM_SALT ".salt"
+
+/**
+ * \def KEYSTREAM_SALT_SIZE
+ * @brief The number of random bytes of the salt.
+ */
+#define KEYSTREAM_SALT_SIZE 32
+
+/**
+ * \def DIGEST_SIZE
+ * @brief The size of a SHA-256 digest.
+ */
+#define DIGEST_SIZE 32
+
+/**
+ * \def KEYSTREAM_CHUNK
+ * @brief The number of words generated and written at once when an entry is created.
+ */
+#define KEYSTREAM_CHUNK 4096
+
+/**
+ * \def KEYSTREAM_BYTE_ORDER
+ * @brief The byte order mark of a cache entry, it reads differently on a machine of another byte order.
+ */
+#define KEYSTREAM_BYTE_ORDER 0x01020304u
+
+/**
+ * \struct KEYSTREAM_HEADER_t
+ * \brief  The header of a cache entry, followed by the words.
+ *
+ * The number of words and the words are stored in the byte order of the machine that wrote them, the byte order
+ * mark tells it apart : an entry written on a machine of another byte order is a miss. The register is never
+ * stored : the check is a salted hash of the register and the tap.
+ */
+typedef struct KEYSTREAM_HEADER_t
+{
+    char magic[8];                    /*!< KEYSTREAM_MAGIC. */
+    uint32_t byteOrder;               /*!< KEYSTREAM_BYTE_ORDER, in the byte order of the machine that wrote the entry. */
+    uint64_t wordsCount;              /*!< The number of words of the entry. */
+    unsigned char check[DIGEST_SIZE]; /*!< The salted hash of the register and the tap the words belong to. */
+} KEYSTREAM_HEADER;
+
+/**
+ * \struct SHA256_t
+ * \brief  The state of a SHA-256 hash.
+ */
+typedef struct SHA256_t
+{
+    uint32_t state[8];       /*!< The intermediate hash. */
+    unsigned char block[64]; /*!< The bytes of the block being filled. */
+    size_t blockSize;        /*!< The number of bytes in block. */
+    uint64_t length;         /*!< The number of bytes hashed. */
+} SHA256;
+
+/**
+ * \struct KEYSTREAM_t
+ * \brief  Data structure representing a keystream loaded from the cache.
+ */
+struct KEYSTREAM_t
+{
+    const uint32_t *words; /*!< The words, inside mapping. */
+    size_t count;          /*!< The number of words available. */
+    void *mapping;         /*!< The cache entry mapped in memory. */
+    size_t mappingSize;    /*!< The size of the mapping. */
+};
+
+/**
+ * \struct CACHE_ENTRY_t
+ * \brief  A file of the cache directory, as seen by the eviction.
+ */
+typedef struct CACHE_ENTRY_t
+{
+    char *name;           /*!< The file name. */
+    off_t size;           /*!< The size of the file. */
+    struct timespec used; /*!< The last use of the entry (its modification time). */
+} CACHE_ENTRY;
+
+/**
+ * \fn static int write_all(int fd, const void *data, size_t size)
+ * \brief Write a buffer entirely.
+ *
+ * \param fd The file descriptor.
+ * \param data The buffer.
+ * \param size The size of the buffer.
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int write_all(int fd, const void *data, size_t size)
+{
+    const char *bytes = data;
+    while (size > 0)
+    {
+        ssize_t result = write(fd, bytes, size);
+        if (result < 0 && errno != EINTR)
+        {
+            return 0;
+        }
+        if (result > 0)
+        {
+            bytes += result;
+            size -= (size_t)result;
+        }
+    }
+    return 1;
+} // end write_all()
+
+/**
+ * \fn static void sha256_block(SHA256 *hash)
+ * \brief Mix a full block in the state of a SHA-256 hash (FIPS 180-4).
+ *
+ * \param hash The hash, its block is full.
+ */
+static void sha256_block(SHA256 *hash)
+{
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+#define ROTATE(x, n) ((x) >> (n) | (x) << (32 - (n)))
+    uint32_t w[64];
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        w[i] = (uint32_t)hash->block[4 * i] << 24 | (uint32_t)hash->block[4 * i + 1] << 16 | (uint32_t)hash->block[4 * i + 2] << 8 | hash->block[4 * i + 3];
+    }
+    for (unsigned int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = ROTATE(w[i - 15], 7) ^ ROTATE(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTATE(w[i - 2], 17) ^ ROTATE(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t v[8];
+    memcpy(v, hash->state, sizeof(v));
+    for (unsigned int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = v[7] + (ROTATE(v[4], 6) ^ ROTATE(v[4], 11) ^ ROTATE(v[4], 25)) + ((v[4] & v[5]) ^ (~v[4] & v[6])) + k[i] + w[i];
+        uint32_t t2 = (ROTATE(v[0], 2) ^ ROTATE(v[0], 13) ^ ROTATE(v[0], 22)) + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        memmove(v + 1, v, 7 * sizeof(uint32_t));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+#undef ROTATE
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        hash->state[i] += v[i];
+    }
+    hash->blockSize = 0;
+} // end sha256_block()
+
+/**
+ * \fn static void sha256_init(SHA256 *hash)
+ * \brief Start a SHA-256 hash.
+ *
+ * \param hash The hash.
+ */
+static void sha256_init(SHA256 *hash)
+{
+    static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(hash->state, initial, sizeof(initial));
+    hash->blockSize = 0;
+    hash->length = 0;
+} // end sha256_init()
+
+/**
+ * \fn static void sha256_update(SHA256 *hash, const void *data, size_t size)
+ * \brief Add bytes to a SHA-256 hash.
+ *
+ * \param hash The hash.
+ * \param data The bytes.
+ * \param size The number of bytes.
+ */
+static void sha256_update(SHA256 *hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    hash->length += size;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash->block[hash->blockSize++] = bytes[i];
+        if (hash->blockSize == sizeof(hash->block))
+        {
+            sha256_block(hash);
+        }
+    }
+} // end sha256_update()
+
+/**
+ * \fn static void sha256_final(SHA256 *hash, unsigned char digest[DIGEST_SIZE])
+ * \brief Finish a SHA-256 hash.
+ *
+ * \param hash The hash.
+ * \param digest The address where to write the digest.
+ */
+static void sha256_final(SHA256 *hash, unsigned char digest[DIGEST_SIZE])
+{
+    uint64_t bits = hash->length * 8;
+    unsigned char padding = 0x80;
+    sha256_update(hash, &padding, 1);
+    padding = 0;
+    while (hash->blockSize != 56)
+    {
+        sha256_update(hash, &padding, 1);
+    }
+    for (int i = 7; i >= 0; i--)
+    {
+        unsigned char byte = (unsigned char)(bits >> (8 * i));
+        sha256_update(hash, &byte, 1);
+    }
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        for (unsigned int b = 0; b < 4; b++)
+        {
+            digest[4 * i + b] = (unsigned char)(hash->state[i] >> (24 - 8 * b));
+        }
+    }
+} // end sha256_final()
+
+/**
+ * \fn static void salted_hash(const unsigned char *salt, char label, char *seed, unsigned int tap, unsigned char digest[DIGEST_SIZE])
+ * \brief Hash a register and a tap with the salt of a cache, the label tells the uses of the hash apart.
+ *
+ * \param salt The salt of the cache, KEYSTREAM_SALT_SIZE bytes.
+ * \param label 'N' for the name of the entry, 'C' for its check.
+ * \param seed The register.
+ * \param tap The tap.
+ * \param digest The address where to write the hash.
+ */
+static void salted_hash(const unsigned char *salt, char label, char *seed, unsigned int tap, unsigned char digest[DIGEST_SIZE])
+{
+    SHA256 hash;
+    unsigned char tapBytes[4] = {(unsigned char)tap, (unsigned char)(tap >> 8), (unsigned char)(tap >> 16), (unsigned char)(tap >> 24)};
+    sha256_init(&hash);
+    sha256_update(&hash, salt, KEYSTREAM_SALT_SIZE);
+    sha256_update(&hash, &label, 1);
+    sha256_update(&hash, tapBytes, sizeof(tapBytes));
+    sha256_update(&hash, seed, strlen(seed));
+    sha256_final(&hash, digest);
+} // end salted_hash()
+
+/**
+ * \fn static int read_salt(char *directory, unsigned char *salt)
+ * \brief Read the salt of a cache directory, created with random bytes the first time.
+ *
+ * \param directory The cache directory, it exists.
+ * \param salt The address where to write the KEYSTREAM_SALT_SIZE bytes of the salt.
+ *
+ * \pre directory is instanced, salt is instanced.
+ * \post The salt is read, it is readable by its owner only.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int read_salt(char *directory, unsigned char *salt)
+{
+    size_t length = strlen(directory) + strlen(KEYSTREAM_SALT) + 9;
+    char *path = malloc(length);
+    char *temporary = malloc(length);
+    if (!path || !temporary)
+    {
+        free(path);
+        free(temporary);
+        return 0;
+    }
+    snprintf(path, length, "%s/%s", directory, KEYSTREAM_SALT);
+
+    // Step 1 : a new salt is written to a temporary file then linked, the first process to link it wins
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 && errno == ENOENT)
+    {
+        snprintf(temporary, length, "%s.XXXXXX", path);
+        int source = open("/dev/urandom", O_RDONLY);
+        int created = mkstemp(temporary);
+        unsigned char bytes[KEYSTREAM_SALT_SIZE];
+        if (source >= 0 && created >= 0 && read(source, bytes, sizeof(bytes)) == (ssize_t)sizeof(bytes) && write_all(created, bytes, sizeof(bytes)))
+        {
+            link(temporary, path);
+        }
+        if (created >= 0)
+        {
+            close(created);
+            unlink(temporary);
+        }
+        if (source >= 0)
+        {
+            close(source);
+        }
+        fd = open(path, O_RDONLY);
+    } // end Step 1
+
+    // Step 2 : the salt
+    int success = fd >= 0 && read(fd, salt, KEYSTREAM_SALT_SIZE) == KEYSTREAM_SALT_SIZE;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    free(path);
+    free(temporary);
+    return success;
+} // end read_salt()
+
+/**
+ * \fn static char *entry_path(char *directory, const unsigned char *salt, char *seed, unsigned int tap)
+ * \brief Build the path of the cache entry of a register and a tap (salted hash of both).
+ *
+ * \param directory The cache directory.
+ * \param salt The salt of the cache.
+ * \param seed The register.
+ * \param tap The tap.
+ *
+ * \pre directory is instanced, salt is instanced, seed is instanced.
+ * \post The path is returned, it has to be freed.
+ *
+ * \return char* The path.
+ *               NULL in case of error.
+ */
+static char *entry_path(char *directory, const unsigned char *salt, char *seed, unsigned int tap)
+{
+    unsigned char digest[DIGEST_SIZE];
+    salted_hash(salt, 'N', seed, tap, digest);
+
+    size_t length = strlen(directory) + 1 + 16 + strlen(KEYSTREAM_EXTENSION) + 1;
+    char *path = malloc(length);
+    if (path)
+    {
+        int written = snprintf(path, length, "%s/", directory);
+        for (unsigned int i = 0; i < 8; i++)
+        {
+            written += snprintf(path + written, length - (size_t)written, "%02x", digest[i]);
+        }
+        snprintf(path + written, length - (size_t)written, "%s", KEYSTREAM_EXTENSION);
+    }
+    return path;
+} // end entry_path()
+
+/**
+ * \fn static KEYSTREAM *map_entry(char *path, const unsigned char *check)
+ * \brief Map a cache entry and check that it belongs to a register and a tap.
+ *
+ * \param path The path of the entry.
+ * \param check The salted hash of the register and the tap.
+ *
+ * \pre path is instanced, check is instanced.
+ * \post The entry is mapped, its modification time is updated for the eviction.
+ *
+ * \return KEYSTREAM* The keystream of the entry.
+ *                    NULL if the entry is missing or doesn't match.
+ */
+static KEYSTREAM *map_entry(char *path, const unsigned char *check)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat fileStatus;
+    KEYSTREAM *keystream = NULL;
+    if (fstat(fd, &fileStatus) == 0 && (size_t)fileStatus.st_size >= sizeof(KEYSTREAM_HEADER))
+    {
+        void *mapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            const KEYSTREAM_HEADER *header = mapping;
+            size_t offset = sizeof(KEYSTREAM_HEADER);
+            int valid = memcmp(header->magic, KEYSTREAM_MAGIC, sizeof(header->magic)) == 0 && header->byteOrder == KEYSTREAM_BYTE_ORDER && memcmp(header->check, check, DIGEST_SIZE) == 0 &&
+                        header->wordsCount <= ((size_t)fileStatus.st_size - offset) / sizeof(uint32_t);
+            if (valid && (keystream = malloc(sizeof(KEYSTREAM))))
+            {
+                keystream->mapping = mapping;
+                keystream->mappingSize = (size_t)fileStatus.st_size;
+                keystream->words = (const uint32_t *)((const char *)mapping + offset);
+                keystream->count = (size_t)header->wordsCount;
+            }
+            else
+            {
+                munmap(mapping, (size_t)fileStatus.st_size);
+            }
+        }
+    }
+    close(fd);
+
+    // the modification time is the last use, a read-only entry simply ages
+    if (keystream)
+    {
+        utimensat(AT_FDCWD, path, NULL, 0);
+    }
+    return keystream;
+} // end map_entry()
+
+/**
+ * \fn static int write_entry(char *path, const unsigned char *check, LFSR *lfsr, KEYSTREAM *prefix, size_t count)
+ * \brief Write the cache entry of a register and a tap, through a temporary file renamed once complete.
+ *
+ * \param path The path of the entry.
+ * \param check The salted hash of the register and the tap.
+ * \param lfsr The lfsr, positioned at the beginning of the keystream.
+ * \param prefix The previous entry whose words are reused, NULL if none.
+ * \param count The number of words of the entry.
+ *
+ * \pre path, check and lfsr are instanced, prefix->count < count.
+ * \post The entry is written, readable by its owner only.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int write_entry(char *path, const unsigned char *check, LFSR *lfsr, KEYSTREAM *prefix, size_t count)
+{
+    // Step 1 : temporary file next to the entry, so that the rename is atomic
+    size_t pathLength = strlen(path);
+    char *temporary = malloc(pathLength + 8);
+    LFSR *generator = copy_lfsr(lfsr);
+    uint32_t *chunk = malloc(KEYSTREAM_CHUNK * sizeof(uint32_t));
+    size_t reused = prefix ? prefix->count : 0;
+    int fd = -1;
+    int success = temporary && generator && chunk && lfsr_jump(generator, (uint64_t)reused * 32) == 0;
+    if (success)
+    {
+        snprintf(temporary, pathLength + 8, "%s.XXXXXX", path);
+        // mkstemp() creates the file for its owner only : the words decrypt every image of their size
+        success = (fd = mkstemp(temporary)) >= 0;
+    } // end Step 1
+
+    // Step 2 : header, words of the previous entry and new words
+    if (success)
+    {
+        KEYSTREAM_HEADER header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, KEYSTREAM_MAGIC, sizeof(header.magic));
+        header.byteOrder = KEYSTREAM_BYTE_ORDER;
+        header.wordsCount = count;
+        memcpy(header.check, check, DIGEST_SIZE);
+        success = write_all(fd, &header, sizeof(header)) &&
+                  (reused == 0 || write_all(fd, prefix->words, reused * sizeof(uint32_t)));
+        for (size_t done = reused; success && done < count; done += KEYSTREAM_CHUNK)
+        {
+            size_t length = count - done < KEYSTREAM_CHUNK ? count - done : KEYSTREAM_CHUNK;
+            lfsr_fill(generator, chunk, length);
+            success = write_all(fd, chunk, length * sizeof(uint32_t));
+        }
+    } // end Step 2
+
+    // Step 3 : publish the entry
+    if (fd >= 0)
+    {
+        success = close(fd) == 0 && success && rename(temporary, path) == 0;
+        if (!success)
+        {
+            unlink(temporary);
+        }
+    } // end Step 3
+
+    free(temporary);
+    free(chunk);
+    if (generator)
+    {
+        free_lfsr(&generator);
+    }
+    return success;
+} // end write_entry()
+
+/**
+ * \fn static int compare_entries(const void *first, const void *second)
+ * \brief Order the cache entries from the least recently used one, for qsort().
+ */
+static int compare_entries(const void *first, const void *second)
+{
+    const CACHE_ENTRY *a = first;
+    const CACHE_ENTRY *b = second;
+    if (a->used.tv_sec != b->used.tv_sec)
+    {
+        return a->used.tv_sec < b->used.tv_sec ? -1 : 1;
+    }
+    if (a->used.tv_nsec != b->used.tv_nsec)
+    {
+        return a->used.tv_nsec < b->used.tv_nsec ? -1 : 1;
+    }
+    return 0;
+} // end compare_entries()
+
+/**
+ * \fn static void evict_entries(char *directory, uint64_t maxBytes, char *kept)
+ * \brief Remove the least recently used entries of a cache until it fits in its size.
+ *
+ * \param directory The cache directory.
+ * \param maxBytes The maximum size of the cache.
+ * \param kept The path of an entry never removed (the one just used).
+ *
+ * \pre directory is instanced, kept is instanced.
+ * \post The cache fits in maxBytes, unless kept alone is bigger.
+ */
+static void evict_entries(char *directory, uint64_t maxBytes, char *kept)
+{
+    DIR *folder = opendir(directory);
+    if (!folder)
+    {
+        return;
+    }
+
+    // Step 1 : list the entries and their size
+    CACHE_ENTRY *entries = NULL;
+    size_t entriesCount = 0;
+    size_t capacity = 0;
+    uint64_t total = 0;
+    size_t extensionLength = strlen(KEYSTREAM_EXTENSION);
+    size_t directoryLength = strlen(directory);
+    struct dirent *file;
+    while ((file = readdir(folder)))
+    {
+        size_t nameLength = strlen(file->d_name);
+        if (nameLength <= extensionLength || strcmp(file->d_name + nameLength - extensionLength, KEYSTREAM_EXTENSION) != 0)
+        {
+            continue;
+        }
+        char *name = malloc(directoryLength + nameLength + 2);
+        struct stat fileStatus;
+        if (!name)
+        {
+            continue;
+        }
+        snprintf(name, directoryLength + nameLength + 2, "%s/%s", directory, file->d_name);
+        if (stat(name, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+        {
+            free(name);
+            continue;
+        }
+        if (entriesCount == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 64;
+            CACHE_ENTRY *larger = realloc(entries, capacity * sizeof(CACHE_ENTRY));
+            if (!larger)
+            {
+                free(name);
+                break;
+            }
+            entries = larger;
+        }
+        entries[entriesCount].name = name;
+        entries[entriesCount].size = fileStatus.st_size;
+        entries[entriesCount].used = fileStatus.st_mtim;
+        entriesCount++;
+        total += (uint64_t)fileStatus.st_size;
+    }
+    closedir(folder);
+    // end Step 1
+
+    // Step 2 : remove the oldest entries, an entry removed while another process maps it stays readable by that process
+    if (entriesCount > 0)
+    {
+        qsort(entries, entriesCount, sizeof(CACHE_ENTRY), compare_entries);
+    }
+    for (size_t i = 0; i < entriesCount && total > maxBytes; i++)
+    {
+        if (strcmp(entries[i].name, kept) != 0 && unlink(entries[i].name) == 0)
+        {
+            total -= (uint64_t)entries[i].size;
+        }
+    }
+    for (size_t i = 0; i < entriesCount; i++)
+    {
+        free(entries[i].name);
+    }
+    free(entries);
+    // end Step 2
+} // end evict_entries()
+
+KEYSTREAM *load_keystream(char *directory, uint64_t maxBytes, LFSR *lfsr, size_t count)
+{
+    assert(directory && lfsr);
+
+    // Step 1 : the directory and its salt, both for their owner only
+    unsigned char salt[KEYSTREAM_SALT_SIZE];
+    if ((mkdir(directory, 0700) != 0 && errno != EEXIST) || !read_salt(directory, salt))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to create the keystream cache [%s].\n", directory);
+        return NULL;
+    } // end Step 1
+
+    // Step 2 : the name and the check of the entry, the register itself is never written
+    unsigned char check[DIGEST_SIZE];
+    char *seed = to_string(lfsr);
+    char *path = seed ? entry_path(directory, salt, seed, get_tap(lfsr)) : NULL;
+    if (!path)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space for the keystream cache.\n");
+        free(seed);
+        return NULL;
+    }
+    salted_hash(salt, 'C', seed, get_tap(lfsr), check);
+    memset(seed, 0, strlen(seed));
+    free(seed);
+    // end Step 2
+
+    // Step 3 : hit, the entry is at least as long as needed
+    KEYSTREAM *keystream = map_entry(path, check);
+    if (keystream && keystream->count >= count)
+    {
+        free(path);
+        return keystream;
+    } // end Step 3
+
+    // Step 4 : miss or partial hit, the entry is written again with the missing words
+    int written = write_entry(path, check, lfsr, keystream, count);
+    if (keystream)
+    {
+        free_keystream(&keystream);
+    }
+    if (written)
+    {
+        keystream = map_entry(path, check);
+        evict_entries(directory, maxBytes, path);
+    }
+    else
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to write the keystream cache entry [%s].\n", path);
+    }
+    // end Step 4
+
+    free(path);
+    // another process may have replaced the entry by a shorter one in the meantime
+    if (keystream && keystream->count < count)
+    {
+        free_keystream(&keystream);
+    }
+    return keystream;
+} // end load_keystream()
+
+const uint32_t *get_keystream_words(KEYSTREAM *keystream)
+{
+    assert(keystream);
+    return keystream->words;
+} // end get_keystream_words()
+
+void free_keystream(KEYSTREAM **keystream)
+{
+    assert(*keystream);
+    munmap((*keystream)->mapping, (*keystream)->mappingSize);
+    free(*keystream);
+    *keystream = NULL;
+} // end free_keystream()
@@ -0,0 +1,66 @@
+/**
+ * \file keystream.h
+ * \brief This file contains type declarations and prototypes of functions for the on-disk cache of lfsr keystreams.
+ * \author Gardier Simon
+ * \date 26.10.2023
+ * \version: V2
+ */
+
+#ifndef __KEYSTREAM__
+#define __KEYSTREAM__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../lfsr/lfsr.h"
+
+/**
+ * \typedef KEYSTREAM
+ * \brief  Data structure representing a keystream loaded from the cache.
+ */
+typedef struct KEYSTREAM_t KEYSTREAM;
+
+/**
+ * \brief Load the keystream of a lfsr from a cache directory, computing and storing it on a miss.
+ *
+ * An entry holds the 32 bits words generated by lfsr_fill() from a register and a tap, its file name and its check
+ * are SHA-256 hashes of both salted with a random secret of the directory : the register itself is never written.
+ * The directory, its salt and its entries are readable by their owner only. A longer entry serves any shorter request, a shorter one is extended from its end. Entries are
+ * written to a temporary file then renamed, so processes sharing the directory only ever see complete entries.
+ * Once an entry is written, the least recently used ones are removed until the cache fits in maxBytes.
+ *
+ * \param directory The cache directory, created if needed.
+ * \param maxBytes The maximum size of the cache.
+ * \param lfsr The lfsr, positioned at the beginning of the keystream. It is not modified.
+ * \param count The number of words needed.
+ *
+ * \pre directory is instanced, lfsr is instanced.
+ * \post The keystream is returned, it has to be released with free_keystream().
+ *
+ * \return KEYSTREAM* The keystream, mapped from the cache.
+ *                    NULL in case of error (the cache is left unchanged).
+ */
+KEYSTREAM *load_keystream(char *directory, uint64_t maxBytes, LFSR *lfsr, size_t count);
+
+/**
+ * \brief Get the words of a keystream.
+ *
+ * \param keystream The keystream.
+ *
+ * \pre keystream is instanced.
+ * \post The words are returned, they stay valid until free_keystream().
+ *
+ * \return const uint32_t* The words, as lfsr_fill() would give them.
+ */
+const uint32_t *get_keystream_words(KEYSTREAM *keystream);
+
+/**
+ * \brief Free a keystream (the cache entry is kept).
+ *
+ * \param keystream The adress of the keystream.
+ *
+ * \pre keystream is instanced.
+ * \post The keystream is frees.
+ */
+void free_keystream(KEYSTREAM **keystream);
+
+#endif // __KEYSTREAM__
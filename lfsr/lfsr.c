@@ -11,7 +11,37 @@
 #include <assert.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 #include "lfsr.h"
+#include "../utils/utils.h"
+
+/**
+ * \def WORD_BITS
+ * The number of register bits packed in a word.
+ */
+#define WORD_BITS 64
+
+/**
+ * \def BYTE_ENGINE_LENGTH
+ * The shortest register advanced 8 bits per table lookup (the shorter ones are advanced one bit at a time).
+ */
+#define BYTE_ENGINE_LENGTH 8
+
+/**
+ * \def SHORT_ENGINE_LENGTH
+ * The shortest register advanced 16 bits per table lookup, its 256 KB table pays off from there.
+ */
+#define SHORT_ENGINE_LENGTH 32
+
+/**
+ * \struct TABLE_t
+ * \brief  The lookup table of the chunk engine, shared by a lfsr and its copies.
+ */
+typedef struct TABLE_t
+{
+    unsigned int users;  /*!< The number of lfsr instances using the table */
+    uint32_t entries[];  /*!< entries[x] : the chunk entering the register for the input x (low 16 bits), and the same bits in keystream order (high 16 bits) */
+} TABLE;
 
 /**
  * \struct LFSR_t
@@ -19,17 +49,129 @@
  */
 struct LFSR_t
 {
-    unsigned int *reg;      /*!< The register */
-    unsigned int regLength; /*!< The length of the register */
-    unsigned int tap;       /*!< The tap a.k.a the index (from the right) / the number of the bit to use for the XOR operation*/
+    uint64_t *words;         /*!< The register packed in words (bit i of the register is the bit i % WORD_BITS of words[i / WORD_BITS]) */
+    unsigned int wordsCount; /*!< The number of words used by the register */
+    unsigned int *reg;       /*!< The register with one int per bit, refreshed by get_register() */
+    unsigned int regLength;  /*!< The length of the register */
+    unsigned int tap;        /*!< The tap a.k.a the index (from the right) / the number of the bit to use for the XOR operation*/
+    uint64_t steps;          /*!< The number of operations walked since the creation (or the copy) */
+    unsigned int chunkBits;  /*!< The number of operations per table lookup, 0 to walk them one at a time */
+    TABLE *table;            /*!< The table of the chunk engine, NULL if chunkBits is 0 */
+};
+
+/**
+ * \struct GALOIS_LFSR_t
+ * \brief  Data structure representing a linear feedback shift register in Galois configuration.
+ */
+struct GALOIS_LFSR_t
+{
+    uint64_t *words;         /*!< The register packed in words, bit 0 of words[0] is the next result */
+    uint64_t *mask;          /*!< The feedback, XORed into the shifted register when the result is 1 */
+    unsigned int wordsCount; /*!< The number of words used by the register */
+    unsigned int regLength;  /*!< The length of the register */
 };
 
+/**
+ * \struct RING_LFSR_t
+ * \brief  Data structure representing a linear feedback shift register kept in a circular buffer.
+ */
+struct RING_LFSR_t
+{
+    unsigned char *bits;     /*!< The register with one byte per bit, bit i of the register is bits[(head + i) % regLength] */
+    unsigned int *reg;       /*!< The register in its logical order, refreshed by ring_get_register() */
+    unsigned int head;       /*!< The index of the first bit of the register in bits */
+    unsigned int feedback;   /*!< The index of the bit L - tap - 1 of the register in bits */
+    unsigned int regLength;  /*!< The length of the register */
+};
+
+/**
+ * \var freedSteps
+ * The number of operations walked by the lfsr instances freed so far, shared by all the threads.
+ */
+static uint64_t freedSteps = 0;
+
+/**
+ * \fn static inline unsigned int get_bit(LFSR *lfsr, unsigned int i)
+ * \brief Read a bit of the packed register.
+ *
+ * \param lfsr The lfsr instance.
+ * \param i The index of the bit (from the left).
+ *
+ * \pre lfsr is instanced, i < lfsr->regLength.
+ * \post The bit is returned.
+ *
+ * \return unsigned int The bit i of the register.
+ */
+static inline unsigned int get_bit(LFSR *lfsr, unsigned int i)
+{
+    return (unsigned int)(lfsr->words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+} // end get_bit()
+
+/**
+ * \fn static int build_table(LFSR *lfsr)
+ * \brief Choose the engine of a lfsr from its length and build the table of the chunk engine.
+ *
+ * Advancing the register by a chunk of c bits, like a table-driven CRC : with d = tap + 1, the bit j of the chunk
+ * is s[j] ^ s[L - d + j], where s[L - d + j] is the bit j - d of the chunk itself once L - d + j reaches L.
+ * Reading the bits beyond the register as 0, the chunk solves chunk[j] = x[j] ^ chunk[j - d] for
+ * x = (first c bits) ^ (c bits from L - d), and the table maps x to that solution.
+ *
+ * \param lfsr The lfsr instance, its length and tap are set.
+ *
+ * \pre lfsr is instanced.
+ * \post chunkBits and table are set.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation
+ */
+static int build_table(LFSR *lfsr)
+{
+    lfsr->table = NULL;
+    lfsr->chunkBits = lfsr->regLength >= SHORT_ENGINE_LENGTH ? 16 : lfsr->regLength >= BYTE_ENGINE_LENGTH ? 8 : 0;
+    if (!lfsr->chunkBits)
+    {
+        return 0;
+    }
+
+    uint32_t size = (uint32_t)1 << lfsr->chunkBits;
+    TABLE *table = malloc(sizeof(TABLE) + size * sizeof(uint32_t));
+    if (!table)
+    {
+        return -1;
+    }
+    table->users = 1;
+    table->entries[0] = 0;
+
+    // Step 1 : a single bit j of x enters at j, then the feedback repeats it every d bits
+    for (unsigned int j = 0; j < lfsr->chunkBits; j++)
+    {
+        uint32_t chunk = 0;
+        uint32_t reversed = 0;
+        for (unsigned int k = j; k < lfsr->chunkBits; k += lfsr->tap + 1)
+        {
+            chunk |= (uint32_t)1 << k;
+            reversed |= (uint32_t)1 << (lfsr->chunkBits - 1 - k);
+        }
+        table->entries[(uint32_t)1 << j] = chunk | reversed << 16;
+    } // end Step 1
+
+    // Step 2 : the solution is linear in x
+    for (uint32_t x = 1; x < size; x++)
+    {
+        table->entries[x] = table->entries[x & (x - 1)] ^ table->entries[x & (~x + 1)];
+    } // end Step 2
+
+    lfsr->table = table;
+    return 0;
+} // end build_table()
+
 LFSR *create_lfsr(char *seed, int tap)
 {
     assert(seed);
-    if (tap < 0 || tap >= (int)strlen(seed))
+    unsigned int seedLength = strlen(seed);
+    if (tap < 0 || tap >= (int)seedLength)
     {
-        printf("> 🔴 Tap out of bounds.\n");
+        fprintf(get_messages_stream(), "> 🔴 Tap out of bounds.\n");
         return NULL;
     }
 
@@ -39,57 +181,429 @@ LFSR *create_lfsr(char *seed, int tap)
         return NULL;
     }
 
-    lfsr->reg = malloc(sizeof(unsigned int) * strlen(seed));
-    if (!lfsr->reg)
+    lfsr->wordsCount = (seedLength + WORD_BITS - 1) / WORD_BITS;
+    lfsr->words = calloc(lfsr->wordsCount, sizeof(uint64_t));
+    lfsr->reg = malloc(sizeof(unsigned int) * seedLength);
+    if (!lfsr->words || !lfsr->reg)
     {
+        free(lfsr->words);
+        free(lfsr->reg);
         free(lfsr);
         return NULL;
     }
-    for (unsigned int i = 0; i < strlen(seed); i++)
+    for (unsigned int i = 0; i < seedLength; i++)
     {
         if (seed[i] != '1' && seed[i] != '0')
         {
+            free(lfsr->words);
             free(lfsr->reg);
             free(lfsr);
-            printf("> 🔴 [%c] isn't allowed in a seed. The seed should contains only 1's and 0's.\n", seed[i]);
+            fprintf(get_messages_stream(), "> 🔴 [%c] isn't allowed in a seed. The seed should contains only 1's and 0's.\n", seed[i]);
             return NULL;
         }
-        lfsr->reg[i] = (unsigned int)(seed[i] - '0');
+        lfsr->words[i / WORD_BITS] |= (uint64_t)(seed[i] - '0') << (i % WORD_BITS);
     }
     lfsr->tap = tap;
-    lfsr->regLength = strlen(seed);
+    lfsr->regLength = seedLength;
+    lfsr->steps = 0;
+    if (build_table(lfsr) != 0)
+    {
+        free(lfsr->words);
+        free(lfsr->reg);
+        free(lfsr);
+        return NULL;
+    }
 
     return lfsr;
 }
 
-unsigned int operation(LFSR *lfsr)
+LFSR *copy_lfsr(LFSR *lfsr)
 {
     assert(lfsr);
 
-    unsigned int xor_operation = lfsr->reg[0] ^ lfsr->reg[lfsr->regLength - lfsr->tap - 1];
+    LFSR *copy = malloc(sizeof(LFSR));
+    if (!copy)
+    {
+        return NULL;
+    }
+    copy->words = malloc(lfsr->wordsCount * sizeof(uint64_t));
+    copy->reg = malloc(lfsr->regLength * sizeof(unsigned int));
+    if (!copy->words || !copy->reg)
+    {
+        free(copy->words);
+        free(copy->reg);
+        free(copy);
+        return NULL;
+    }
+    memcpy(copy->words, lfsr->words, lfsr->wordsCount * sizeof(uint64_t));
+    copy->wordsCount = lfsr->wordsCount;
+    copy->regLength = lfsr->regLength;
+    copy->tap = lfsr->tap;
+    copy->steps = 0;
+    copy->chunkBits = lfsr->chunkBits;
+    copy->table = lfsr->table;
+    if (copy->table)
+    {
+        __atomic_fetch_add(&copy->table->users, 1, __ATOMIC_RELAXED);
+    }
+
+    return copy;
+}
+
+/**
+ * \fn static inline unsigned int step(LFSR *lfsr)
+ * \brief Shift the packed register and return the feedback bit (operation() without the checks).
+ *
+ * \param lfsr The lfsr instance.
+ *
+ * \pre lfsr is instanced.
+ * \post The register is shifted.
+ *
+ * \return unsigned int The result of the XOR operation.
+ */
+static inline unsigned int step(LFSR *lfsr)
+{
+    uint64_t *words = lfsr->words;
+    unsigned int last = lfsr->wordsCount - 1;
+    uint64_t xor_operation = (uint64_t)(get_bit(lfsr, 0) ^ get_bit(lfsr, lfsr->regLength - lfsr->tap - 1));
+
+    // the bits beyond regLength are always 0, so the top bit is free after the shift
+    for (unsigned int i = 0; i < last; i++)
+    {
+        words[i] = (words[i] >> 1) | (words[i + 1] << (WORD_BITS - 1));
+    }
+    words[last] = (words[last] >> 1) | (xor_operation << ((lfsr->regLength - 1) % WORD_BITS));
+    return (unsigned int)xor_operation;
+} // end step()
+
+/**
+ * \fn static inline unsigned int advance(LFSR *lfsr)
+ * \brief Make chunkBits operations with a single table lookup (see build_table()).
+ *
+ * \param lfsr The lfsr instance.
+ *
+ * \pre lfsr is instanced, chunkBits > 0.
+ * \post The register is the one reached after chunkBits calls to step().
+ *
+ * \return unsigned int The results of the operations, the first one in the most significant bit.
+ */
+static inline unsigned int advance(LFSR *lfsr)
+{
+    uint64_t *words = lfsr->words;
+    unsigned int last = lfsr->wordsCount - 1;
+    unsigned int bits = lfsr->chunkBits;
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
 
-    for (unsigned int i = 0; i < lfsr->regLength - 1; i++)
+    // Step 1 : look up the first bits XOR the bits from L - tap - 1, those beyond the register are 0
+    unsigned int position = lfsr->regLength - lfsr->tap - 1;
+    unsigned int w = position / WORD_BITS;
+    unsigned int shift = position % WORD_BITS;
+    uint64_t window = words[w] >> shift;
+    if (shift + bits > WORD_BITS && w < last)
     {
-        lfsr->reg[i] = lfsr->reg[i + 1];
+        window |= words[w + 1] << (WORD_BITS - shift);
     }
-    lfsr->reg[lfsr->regLength - 1] = xor_operation;
-    return xor_operation;
+    uint32_t entry = lfsr->table->entries[(words[0] ^ window) & mask];
+
+    // Step 2 : shift the register, the chunk enters at its end
+    for (unsigned int i = 0; i < last; i++)
+    {
+        words[i] = (words[i] >> bits) | (words[i + 1] << (WORD_BITS - bits));
+    }
+    words[last] >>= bits;
+    position = lfsr->regLength - bits;
+    w = position / WORD_BITS;
+    shift = position % WORD_BITS;
+    words[w] |= (entry & mask) << shift;
+    if (shift + bits > WORD_BITS)
+    {
+        words[w + 1] |= (entry & mask) >> (WORD_BITS - shift);
+    }
+    return entry >> 16;
+} // end advance()
+
+unsigned int operation(LFSR *lfsr)
+{
+    assert(lfsr);
+    lfsr->steps++;
+    return step(lfsr);
 }
 
 unsigned int generation(LFSR *lfsr, unsigned int k)
 {
     assert(lfsr);
     unsigned int valueGenerated = 0;
-    for (unsigned int i = 0; i < k; i++)
+    unsigned int i = 0;
+    lfsr->steps += k;
+    if (lfsr->chunkBits)
     {
-        valueGenerated = valueGenerated * 2 + operation(lfsr);
+        for (; i + lfsr->chunkBits <= k; i += lfsr->chunkBits)
+        {
+            valueGenerated = (valueGenerated << lfsr->chunkBits) | advance(lfsr);
+        }
+    }
+    for (; i < k; i++)
+    {
+        valueGenerated = valueGenerated * 2 + step(lfsr);
     }
     return valueGenerated;
 }
 
+void lfsr_fill(LFSR *lfsr, uint32_t *out, size_t n)
+{
+    assert(lfsr && (out || n == 0));
+    lfsr->steps += 32 * (uint64_t)n;
+    if (lfsr->chunkBits)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t valueGenerated = 0;
+            for (unsigned int k = 0; k < 32; k += lfsr->chunkBits)
+            {
+                valueGenerated = (valueGenerated << lfsr->chunkBits) | advance(lfsr);
+            }
+            out[i] = valueGenerated;
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t valueGenerated = 0;
+        for (unsigned int k = 0; k < 32; k++)
+        {
+            valueGenerated = (valueGenerated << 1) | step(lfsr);
+        }
+        out[i] = valueGenerated;
+    }
+}
+
+/**
+ * \fn static void poly_flip(uint64_t *poly, unsigned int i)
+ * \brief Flip the coefficient of x^i in a packed GF(2) polynomial.
+ *
+ * \param poly The polynomial (coefficient i is the bit i % WORD_BITS of poly[i / WORD_BITS]).
+ * \param i The degree of the coefficient.
+ *
+ * \pre poly is instanced and holds the coefficient i.
+ * \post The coefficient is flipped.
+ */
+static void poly_flip(uint64_t *poly, unsigned int i)
+{
+    poly[i / WORD_BITS] ^= (uint64_t)1 << (i % WORD_BITS);
+} // end poly_flip()
+
+/**
+ * \fn static unsigned int poly_coefficient(const uint64_t *poly, unsigned int i)
+ * \brief Read the coefficient of x^i in a packed GF(2) polynomial.
+ *
+ * \param poly The polynomial.
+ * \param i The degree of the coefficient.
+ *
+ * \pre poly is instanced and holds the coefficient i.
+ * \post The coefficient is returned.
+ *
+ * \return unsigned int The coefficient (0 or 1).
+ */
+static unsigned int poly_coefficient(const uint64_t *poly, unsigned int i)
+{
+    return (unsigned int)(poly[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+} // end poly_coefficient()
+
+/**
+ * \fn static void poly_reduce(LFSR *lfsr, uint64_t *poly, unsigned int degree)
+ * \brief Reduce a polynomial modulo the characteristic polynomial x^L + x^(L-tap-1) + 1 of the register.
+ *
+ * The feedback of operation() is s[n+L] = s[n] ^ s[n+L-tap-1], so x^d can be replaced by x^(d-L) + x^(d-tap-1).
+ *
+ * \param lfsr The lfsr instance (L is its length).
+ * \param poly The polynomial to reduce.
+ * \param degree The highest degree that may be set in poly.
+ *
+ * \pre lfsr is instanced, poly is instanced.
+ * \post poly has a degree < L.
+ */
+static void poly_reduce(LFSR *lfsr, uint64_t *poly, unsigned int degree)
+{
+    for (unsigned int d = degree; d >= lfsr->regLength; d--)
+    {
+        if (poly_coefficient(poly, d))
+        {
+            poly_flip(poly, d);
+            poly_flip(poly, d - lfsr->regLength);
+            poly_flip(poly, d - lfsr->tap - 1);
+        }
+    }
+} // end poly_reduce()
+
+/**
+ * \fn static void poly_mul_mod(LFSR *lfsr, const uint64_t *a, const uint64_t *b, uint64_t *result, uint64_t *product)
+ * \brief Multiply two polynomials of degree < L modulo the characteristic polynomial of the register.
+ *
+ * \param lfsr The lfsr instance.
+ * \param a The first factor (wordsCount words).
+ * \param b The second factor (wordsCount words).
+ * \param result The reduced product (wordsCount words), may alias a or b.
+ * \param product A scratch buffer of 2 * wordsCount words.
+ *
+ * \pre All the buffers are instanced.
+ * \post result = a * b mod the characteristic polynomial.
+ */
+static void poly_mul_mod(LFSR *lfsr, const uint64_t *a, const uint64_t *b, uint64_t *result, uint64_t *product)
+{
+    unsigned int n = lfsr->wordsCount;
+    memset(product, 0, 2 * n * sizeof(uint64_t));
+
+    for (unsigned int i = 0; i < lfsr->regLength; i++)
+    {
+        if (!poly_coefficient(a, i))
+        {
+            continue;
+        }
+        unsigned int offset = i / WORD_BITS;
+        unsigned int shift = i % WORD_BITS;
+        for (unsigned int w = 0; w < n; w++)
+        {
+            product[w + offset] ^= b[w] << shift;
+            if (shift)
+            {
+                product[w + offset + 1] ^= b[w] >> (WORD_BITS - shift);
+            }
+        }
+    }
+
+    poly_reduce(lfsr, product, 2 * lfsr->regLength - 2);
+    memcpy(result, product, n * sizeof(uint64_t));
+} // end poly_mul_mod()
+
+/**
+ * \fn static void poly_mul_x(LFSR *lfsr, uint64_t *poly, uint64_t *product)
+ * \brief Multiply a polynomial of degree < L by x modulo the characteristic polynomial of the register.
+ *
+ * \param lfsr The lfsr instance.
+ * \param poly The polynomial (wordsCount words), multiplied in place.
+ * \param product A scratch buffer of 2 * wordsCount words.
+ *
+ * \pre All the buffers are instanced.
+ * \post poly = poly * x mod the characteristic polynomial.
+ */
+static void poly_mul_x(LFSR *lfsr, uint64_t *poly, uint64_t *product)
+{
+    unsigned int n = lfsr->wordsCount;
+    memset(product, 0, 2 * n * sizeof(uint64_t));
+    for (unsigned int w = 0; w < n; w++)
+    {
+        product[w] |= poly[w] << 1;
+        product[w + 1] |= poly[w] >> (WORD_BITS - 1);
+    }
+    poly_reduce(lfsr, product, lfsr->regLength);
+    memcpy(poly, product, n * sizeof(uint64_t));
+} // end poly_mul_x()
+
+/**
+ * \fn static unsigned int parity(uint64_t word)
+ * \brief Compute the parity of a word.
+ *
+ * \param word The word.
+ *
+ * \return unsigned int 1 if an odd number of bits are set, 0 otherwise.
+ */
+static unsigned int parity(uint64_t word)
+{
+    word ^= word >> 32;
+    word ^= word >> 16;
+    word ^= word >> 8;
+    word ^= word >> 4;
+    word ^= word >> 2;
+    word ^= word >> 1;
+    return (unsigned int)word & 1;
+} // end parity()
+
+int lfsr_jump(LFSR *lfsr, uint64_t steps)
+{
+    assert(lfsr);
+
+    // a short jump is cheaper to walk than to compute, like a long one it isn't counted in the steps
+    if (steps < (uint64_t)lfsr->regLength * WORD_BITS)
+    {
+        for (; lfsr->chunkBits && steps >= lfsr->chunkBits; steps -= lfsr->chunkBits)
+        {
+            advance(lfsr);
+        }
+        for (uint64_t i = 0; i < steps; i++)
+        {
+            step(lfsr);
+        }
+        return 0;
+    }
+
+    unsigned int n = lfsr->wordsCount;
+    unsigned int L = lfsr->regLength;
+    uint64_t *buffer = calloc(5 * n + 1, sizeof(uint64_t));
+    if (!buffer)
+    {
+        return -1;
+    }
+    uint64_t *power = buffer;            // x^steps mod P, n words
+    uint64_t *product = buffer + n;      // scratch for the products, 2n words
+    uint64_t *sequence = buffer + 3 * n; // s[0 .. 2L-2], 2n + 1 words
+
+    // Step 1 : power = x^steps mod P (square and multiply from the most significant bit)
+    poly_flip(power, 0);
+    for (int bit = 63; bit >= 0; bit--)
+    {
+        poly_mul_mod(lfsr, power, power, power, product);
+        if ((steps >> bit) & 1)
+        {
+            poly_mul_x(lfsr, power, product);
+        }
+    } // end Step 1
+
+    // Step 2 : extend the sequence of the register to s[0 .. 2L-2]
+    memcpy(sequence, lfsr->words, n * sizeof(uint64_t));
+    for (unsigned int i = L; i < 2 * L - 1; i++)
+    {
+        if (poly_coefficient(sequence, i - L) ^ poly_coefficient(sequence, i - lfsr->tap - 1))
+        {
+            poly_flip(sequence, i);
+        }
+    } // end Step 2
+
+    // Step 3 : s[steps + j] = sum of power[i] * s[i + j]
+    for (unsigned int w = 0; w < n; w++)
+    {
+        lfsr->words[w] = 0;
+    }
+    for (unsigned int j = 0; j < L; j++)
+    {
+        unsigned int offset = j / WORD_BITS;
+        unsigned int shift = j % WORD_BITS;
+        uint64_t sum = 0;
+        for (unsigned int w = 0; w < n; w++)
+        {
+            uint64_t window = sequence[w + offset] >> shift;
+            if (shift)
+            {
+                window |= sequence[w + offset + 1] << (WORD_BITS - shift);
+            }
+            sum ^= window & power[w];
+        }
+        if (parity(sum))
+        {
+            poly_flip(lfsr->words, j);
+        }
+    } // end Step 3
+
+    free(buffer);
+    return 0;
+} // end lfsr_jump()
+
 unsigned int *get_register(LFSR *lfsr)
 {
     assert(lfsr);
+    for (unsigned int i = 0; i < lfsr->regLength; i++)
+    {
+        lfsr->reg[i] = get_bit(lfsr, i);
+    }
     return lfsr->reg;
 }
 
@@ -103,18 +617,309 @@ char *to_string(LFSR *lfsr)
 {
     assert(lfsr);
 
-    char *stringRepresentation = malloc(lfsr->regLength * sizeof(char));
+    char *stringRepresentation = malloc((lfsr->regLength + 1) * sizeof(char));
+    if (!stringRepresentation)
+    {
+        return NULL;
+    }
     for (unsigned int i = 0; i < lfsr->regLength; i++)
     {
-        stringRepresentation[i] = (char)lfsr->reg[i] + '0';
+        stringRepresentation[i] = (char)get_bit(lfsr, i) + '0';
     }
+    stringRepresentation[lfsr->regLength] = '\0';
 
     return stringRepresentation;
 }
 
+GALOIS_LFSR *create_galois_lfsr(LFSR *lfsr)
+{
+    assert(lfsr);
+    unsigned int L = lfsr->regLength;
+
+    GALOIS_LFSR *galois = malloc(sizeof(GALOIS_LFSR));
+    LFSR *ahead = copy_lfsr(lfsr);
+    if (!galois || !ahead)
+    {
+        free(galois);
+        if (ahead)
+        {
+            free_lfsr(&ahead);
+        }
+        return NULL;
+    }
+    galois->wordsCount = lfsr->wordsCount;
+    galois->regLength = L;
+    galois->words = calloc(galois->wordsCount, sizeof(uint64_t));
+    galois->mask = calloc(galois->wordsCount, sizeof(uint64_t));
+    if (!galois->words || !galois->mask)
+    {
+        free_galois_lfsr(&galois);
+        free_lfsr(&ahead);
+        return NULL;
+    }
+
+    // Step 1 : the Fibonacci results are r[n + L] = r[n] ^ r[n + L - tap - 1], the Galois ones are
+    //          r[n + L] = mask[L - 1] * r[n] ^ (sum of mask[j] * r[n + L - 1 - j] for j < L - 1), so the mask holds
+    //          the bits L - 1 and tap (none when tap = L - 1, r[n + L] is then 0)
+    poly_flip(galois->mask, L - 1);
+    poly_flip(galois->mask, lfsr->tap);
+
+    // Step 2 : the next L results r[0 .. L - 1] of the Fibonacci register, walked on a copy (not counted in the steps)
+    for (unsigned int k = 0; k < L; k++)
+    {
+        if (step(ahead))
+        {
+            poly_flip(galois->words, k);
+        }
+    }
+    free_lfsr(&ahead);
+
+    // Step 3 : the Galois register emitting them holds g[k] = r[k] ^ (sum of mask[j] * r[k - 1 - j] for j < k),
+    //          from the highest k down so that the r read are not modified yet
+    if (lfsr->tap < L - 1)
+    {
+        for (unsigned int k = L - 1; k > lfsr->tap; k--)
+        {
+            if (poly_coefficient(galois->words, k - 1 - lfsr->tap))
+            {
+                poly_flip(galois->words, k);
+            }
+        }
+    }
+
+    return galois;
+}
+
+/**
+ * \fn static inline unsigned int galois_step(GALOIS_LFSR *galois)
+ * \brief Shift a Galois register and apply the feedback with one masked XOR per word.
+ *
+ * \param galois The Galois lfsr instance.
+ *
+ * \pre galois is instanced.
+ * \post The register is shifted.
+ *
+ * \return unsigned int The result of the operation.
+ */
+static inline unsigned int galois_step(GALOIS_LFSR *galois)
+{
+    uint64_t *words = galois->words;
+    unsigned int last = galois->wordsCount - 1;
+    unsigned int result = (unsigned int)words[0] & 1;
+    uint64_t feedback = (uint64_t)0 - result;
+
+    for (unsigned int i = 0; i < last; i++)
+    {
+        words[i] = ((words[i] >> 1) | (words[i + 1] << (WORD_BITS - 1))) ^ (galois->mask[i] & feedback);
+    }
+    words[last] = (words[last] >> 1) ^ (galois->mask[last] & feedback);
+    return result;
+} // end galois_step()
+
+unsigned int galois_operation(GALOIS_LFSR *galois)
+{
+    assert(galois);
+    return galois_step(galois);
+}
+
+void galois_fill(GALOIS_LFSR *galois, uint32_t *out, size_t n)
+{
+    assert(galois && (out || n == 0));
+
+    // a register of a single word stays in a local variable
+    if (galois->wordsCount == 1)
+    {
+        uint64_t word = galois->words[0];
+        uint64_t mask = galois->mask[0];
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t valueGenerated = 0;
+            for (unsigned int k = 0; k < 32; k++)
+            {
+                uint64_t result = word & 1;
+                word = (word >> 1) ^ (mask & ((uint64_t)0 - result));
+                valueGenerated = (valueGenerated << 1) | (uint32_t)result;
+            }
+            out[i] = valueGenerated;
+        }
+        galois->words[0] = word;
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t valueGenerated = 0;
+        for (unsigned int k = 0; k < 32; k++)
+        {
+            valueGenerated = (valueGenerated << 1) | galois_step(galois);
+        }
+        out[i] = valueGenerated;
+    }
+}
+
+void free_galois_lfsr(GALOIS_LFSR **galois)
+{
+    assert(*galois);
+    free((*galois)->words);
+    free((*galois)->mask);
+    free(*galois);
+    *galois = NULL;
+}
+
+RING_LFSR *create_ring_lfsr(LFSR *lfsr)
+{
+    assert(lfsr);
+    unsigned int L = lfsr->regLength;
+
+    RING_LFSR *ring = malloc(sizeof(RING_LFSR));
+    if (!ring)
+    {
+        return NULL;
+    }
+    ring->regLength = L;
+    ring->bits = malloc(L * sizeof(unsigned char));
+    ring->reg = malloc(L * sizeof(unsigned int));
+    if (!ring->bits || !ring->reg)
+    {
+        free_ring_lfsr(&ring);
+        return NULL;
+    }
+
+    // the head starts at index 0, the buffer holds the register in its logical order
+    for (unsigned int i = 0; i < L; i++)
+    {
+        ring->bits[i] = (unsigned char)get_bit(lfsr, i);
+    }
+    ring->head = 0;
+    ring->feedback = L - lfsr->tap - 1;
+
+    return ring;
+}
+
+/**
+ * \fn static inline unsigned int ring_step(RING_LFSR *ring)
+ * \brief Make an operation on a ring register : two reads, one XOR, one write and the indexes moved.
+ *
+ * \param ring The ring lfsr instance.
+ *
+ * \pre ring is instanced.
+ * \post The head moves one bit forward.
+ *
+ * \return unsigned int The result of the operation.
+ */
+static inline unsigned int ring_step(RING_LFSR *ring)
+{
+    unsigned char result = ring->bits[ring->head] ^ ring->bits[ring->feedback];
+
+    // the first bit leaves the register, the result enters at its end, which is the same place once the head has moved
+    ring->bits[ring->head] = result;
+    ring->head = ring->head + 1 == ring->regLength ? 0 : ring->head + 1;
+    ring->feedback = ring->feedback + 1 == ring->regLength ? 0 : ring->feedback + 1;
+    return result;
+} // end ring_step()
+
+unsigned int ring_operation(RING_LFSR *ring)
+{
+    assert(ring);
+    return ring_step(ring);
+}
+
+void ring_fill(RING_LFSR *ring, uint32_t *out, size_t n)
+{
+    assert(ring && (out || n == 0));
+
+    // the indexes stay in local variables during the fill
+    unsigned char *bits = ring->bits;
+    unsigned int L = ring->regLength;
+    unsigned int head = ring->head;
+    unsigned int feedback = ring->feedback;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t valueGenerated = 0;
+        for (unsigned int k = 0; k < 32; k++)
+        {
+            unsigned char result = bits[head] ^ bits[feedback];
+            bits[head] = result;
+            head = head + 1 == L ? 0 : head + 1;
+            feedback = feedback + 1 == L ? 0 : feedback + 1;
+            valueGenerated = (valueGenerated << 1) | result;
+        }
+        out[i] = valueGenerated;
+    }
+    ring->head = head;
+    ring->feedback = feedback;
+}
+
+unsigned int *ring_get_register(RING_LFSR *ring)
+{
+    assert(ring);
+
+    // the bits from the head to the end of the buffer, then the ones before the head
+    unsigned int tail = ring->regLength - ring->head;
+    for (unsigned int i = 0; i < tail; i++)
+    {
+        ring->reg[i] = ring->bits[ring->head + i];
+    }
+    for (unsigned int i = 0; i < ring->head; i++)
+    {
+        ring->reg[tail + i] = ring->bits[i];
+    }
+    return ring->reg;
+}
+
+char *ring_to_string(RING_LFSR *ring)
+{
+    assert(ring);
+
+    char *stringRepresentation = malloc((ring->regLength + 1) * sizeof(char));
+    if (!stringRepresentation)
+    {
+        return NULL;
+    }
+    unsigned int *reg = ring_get_register(ring);
+    for (unsigned int i = 0; i < ring->regLength; i++)
+    {
+        stringRepresentation[i] = (char)reg[i] + '0';
+    }
+    stringRepresentation[ring->regLength] = '\0';
+
+    return stringRepresentation;
+}
+
+void free_ring_lfsr(RING_LFSR **ring)
+{
+    assert(*ring);
+    free((*ring)->bits);
+    free((*ring)->reg);
+    free(*ring);
+    *ring = NULL;
+}
+
+uint64_t get_steps(LFSR *lfsr)
+{
+    assert(lfsr);
+    return lfsr->steps;
+}
+
+uint64_t get_freed_steps(void)
+{
+    return __atomic_load_n(&freedSteps, __ATOMIC_RELAXED);
+}
+
 void free_lfsr(LFSR **lfsr)
 {
     assert(*lfsr);
+    __atomic_fetch_add(&freedSteps, (*lfsr)->steps, __ATOMIC_RELAXED);
+    if ((*lfsr)->table && __atomic_sub_fetch(&(*lfsr)->table->users, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        free((*lfsr)->table);
+    }
+    (*lfsr)->table = NULL;
+    if ((*lfsr)->words)
+    {
+        free((*lfsr)->words);
+        (*lfsr)->words = NULL;
+    }
     if ((*lfsr)->reg)
     {
         free((*lfsr)->reg);
@@ -9,15 +9,34 @@
 #ifndef __LFSR__
 #define __LFSR__
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * \typedef LFSR
  * \brief  Data structure representing a linear feedback shift register.
  */
 typedef struct LFSR_t LFSR;
 
+/**
+ * \typedef GALOIS_LFSR
+ * \brief  Data structure representing a linear feedback shift register in Galois configuration.
+ */
+typedef struct GALOIS_LFSR_t GALOIS_LFSR;
+
+/**
+ * \typedef RING_LFSR
+ * \brief  Data structure representing a linear feedback shift register kept in a circular buffer.
+ */
+typedef struct RING_LFSR_t RING_LFSR;
+
 /**
  * \brief Create an lfsr instance.
  *
+ * A register of 8 bits or more is advanced a chunk of 8 bits (16 bits from 32 bits on) per table lookup by
+ * generation(), lfsr_fill() and lfsr_jump(), the table being built here from the length and the tap. The
+ * results are the ones of operation().
+ *
  * \param seed The seed of the lfsr.
  * \param tap The number of the bit (considering reading from right to left) for the XOR operation on the register.
  *
@@ -29,6 +48,19 @@ typedef struct LFSR_t LFSR;
  */
 LFSR *create_lfsr(char *seed, int tap);
 
+/**
+ * \brief Create an independent copy of a lfsr instance.
+ *
+ * \param lfsr The lfsr instance to copy.
+ *
+ * \pre lfsr is instanced.
+ * \post A lfsr instance with the same register and tap is returned.
+ *
+ * \return LFSR* The pointer dynamically allocated.
+ *               NULL in case of error.
+ */
+LFSR *copy_lfsr(LFSR *lfsr);
+
 /**
  * \brief Shift a register to the left and return the XOR operation BT the tap bit and the most significant byte.
  *
@@ -54,6 +86,32 @@ unsigned int operation(LFSR *lfsr);
  */
 unsigned int generation(LFSR *lfsr, unsigned int k);
 
+/**
+ * \brief Fill a buffer with 32 bits keystream words.
+ *
+ * \param lfsr The lfsr instance.
+ * \param out The buffer to fill.
+ * \param n The number of words to write in out.
+ *
+ * \pre lfsr is instanced, out can hold n words.
+ * \post out[i] is the value the (i+1)th call to generation(lfsr, 32) would have returned.
+ */
+void lfsr_fill(LFSR *lfsr, uint32_t *out, size_t n);
+
+/**
+ * \brief Advance the register as if operation() had been called steps times, in logarithmic time.
+ *
+ * \param lfsr The lfsr instance.
+ * \param steps The number of operations to skip.
+ *
+ * \pre lfsr is instanced.
+ * \post The register is the one reached after steps operations, get_steps() is unchanged.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation (the register is left unchanged)
+ */
+int lfsr_jump(LFSR *lfsr, uint64_t steps);
+
 /**
  * \brief Get the register of the lfsr instance.
  *
@@ -90,6 +148,153 @@ unsigned int get_tap(LFSR *lfsr);
  */
 char *to_string(LFSR *lfsr);
 
+/**
+ * \brief Create the Galois register equivalent to a lfsr instance.
+ *
+ * The (Fibonacci) lfsr XORs two bits of the register then shifts it entirely, the Galois register shifts and
+ * applies its feedback with one masked XOR per word. Both follow the characteristic polynomial
+ * x^L + x^(L - tap - 1) + 1, the Galois register is loaded with the state that emits the next results of lfsr.
+ *
+ * \param lfsr The lfsr instance. It is not modified.
+ *
+ * \pre lfsr is instanced.
+ * \post A Galois lfsr is returned, its i-th operation gives the result of the i-th operation() on lfsr.
+ *
+ * \return GALOIS_LFSR* The pointer dynamically allocated.
+ *                      NULL in case of error.
+ */
+GALOIS_LFSR *create_galois_lfsr(LFSR *lfsr);
+
+/**
+ * \brief Make an operation on a Galois register.
+ *
+ * \param galois The Galois lfsr instance.
+ *
+ * \pre galois is instanced.
+ * \post The register is shifted, the feedback applied.
+ *
+ * \return unsigned int The result of the operation.
+ */
+unsigned int galois_operation(GALOIS_LFSR *galois);
+
+/**
+ * \brief Fill a buffer with 32 bits keystream words of a Galois register.
+ *
+ * \param galois The Galois lfsr instance.
+ * \param out The buffer to fill.
+ * \param n The number of words to write in out.
+ *
+ * \pre galois is instanced, out can hold n words.
+ * \post out is filled as lfsr_fill() would with the equivalent lfsr.
+ */
+void galois_fill(GALOIS_LFSR *galois, uint32_t *out, size_t n);
+
+/**
+ * \brief Free a Galois lfsr structure.
+ *
+ * \param galois The adress of the instance to free.
+ *
+ * \pre galois is instanced.
+ * \post The memory space is frees.
+ */
+void free_galois_lfsr(GALOIS_LFSR **galois);
+
+/**
+ * \brief Create the circular buffer register equivalent to a lfsr instance.
+ *
+ * The register isn't shifted : a head index moves along a circular buffer holding one bit per byte, so an operation
+ * reads the head and the tap, writes their XOR at the head (the logical end of the register) and moves both indexes.
+ *
+ * \param lfsr The lfsr instance. It is not modified.
+ *
+ * \pre lfsr is instanced.
+ * \post A ring lfsr is returned with the register of lfsr, its i-th operation gives the result of the i-th operation() on lfsr.
+ *
+ * \return RING_LFSR* The pointer dynamically allocated.
+ *                    NULL in case of error.
+ */
+RING_LFSR *create_ring_lfsr(LFSR *lfsr);
+
+/**
+ * \brief Make an operation on a ring register, in constant time whatever its length.
+ *
+ * \param ring The ring lfsr instance.
+ *
+ * \pre ring is instanced.
+ * \post The head moves one bit forward, the result takes the place of the first bit.
+ *
+ * \return unsigned int The result of the operation.
+ */
+unsigned int ring_operation(RING_LFSR *ring);
+
+/**
+ * \brief Fill a buffer with 32 bits keystream words of a ring register.
+ *
+ * \param ring The ring lfsr instance.
+ * \param out The buffer to fill.
+ * \param n The number of words to write in out.
+ *
+ * \pre ring is instanced, out can hold n words.
+ * \post out is filled as lfsr_fill() would with the equivalent lfsr.
+ */
+void ring_fill(RING_LFSR *ring, uint32_t *out, size_t n);
+
+/**
+ * \brief Get the register of a ring lfsr, in the order of get_register() (from the bit read first).
+ *
+ * \param ring The ring lfsr instance.
+ *
+ * \pre ring is instanced.
+ * \post The register is returned.
+ *
+ * \return unsigned int* The register, owned by ring and refreshed by each call.
+ */
+unsigned int *ring_get_register(RING_LFSR *ring);
+
+/**
+ * \brief Get the string representation of a ring lfsr, in the order of to_string().
+ *
+ * \param ring The ring lfsr instance.
+ *
+ * \pre ring is instanced.
+ * \post The string representation is returned.
+ *
+ * \return char* The string dynamically allocated.
+ *               NULL in case of error.
+ */
+char *ring_to_string(RING_LFSR *ring);
+
+/**
+ * \brief Free a ring lfsr structure.
+ *
+ * \param ring The adress of the instance to free.
+ *
+ * \pre ring is instanced.
+ * \post The memory space is frees.
+ */
+void free_ring_lfsr(RING_LFSR **ring);
+
+/**
+ * \brief Get the number of operations walked by a lfsr instance.
+ *
+ * The operations skipped by lfsr_jump() aren't counted, short or long.
+ *
+ * \param lfsr The lfsr instance.
+ *
+ * \pre lfsr is instanced.
+ * \post The number of operations since create_lfsr() or copy_lfsr() is returned.
+ *
+ * \return uint64_t The number of operations.
+ */
+uint64_t get_steps(LFSR *lfsr);
+
+/**
+ * \brief Get the number of operations walked by all the lfsr instances freed so far, copies included.
+ *
+ * \return uint64_t The sum of get_steps() of the freed instances.
+ */
+uint64_t get_freed_steps(void);
+
 /**
  * \brief Free a lfsr structure.
  *
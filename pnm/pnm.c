@@ -6,402 +6,3365 @@
  * \version: V2
  */
 
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "pnm.h"
 #include "../utils/utils.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+/**
+ * \def XOR_MAX_SIMD
+ * @brief Defined when the SSE2 / AVX2 kernels of the encryption are compiled.
+ */
+#define XOR_MAX_SIMD
+#endif
+
 /**
  * \def MAGIC_NUMBER_LEN
  * @brief The size of a magic number.
  */
-#define MAGIC_NUMBER_LEN 3
+#define MAGIC_NUMBER_LEN 3
+
+/**
+ * \def MAGIC_NUMBERS_COUNT
+ * @brief The number of supported magic numbers.
+ */
+#define MAGIC_NUMBERS_COUNT 6
+
+/**
+ * \def KEYSTREAM_BLOCK
+ * @brief The number of keystream words generated at once during the encryption.
+ */
+#define KEYSTREAM_BLOCK 1024
+
+/**
+ * \def READER_BUFFER_SIZE
+ * @brief The number of bytes read from a file at once when loading an image.
+ */
+#define READER_BUFFER_SIZE (1 << 20)
+
+/**
+ * \def READER_MAPPING_WINDOW
+ * @brief The number of bytes of a mapped file exposed at once, the previous window is released from memory when moving to the next one.
+ */
+#define READER_MAPPING_WINDOW (4 << 20)
+
+/**
+ * \def WRITER_BUFFER_SIZE
+ * @brief The minimum number of bytes formatted before a write() when saving an image.
+ */
+#define WRITER_BUFFER_SIZE (1 << 20)
+
+/**
+ * \def PIPELINE_BAND_SIZE
+ * @brief The number of pixel bytes in a band of lines handed from a stage of the streaming pipeline to the next one.
+ */
+#define PIPELINE_BAND_SIZE (64 << 10)
+
+/**
+ * \def PARSE_CHUNK_MIN_SIZE
+ * The smallest part of an ASCII pixels matrix tokenized by a thread of its own, in bytes.
+ */
+#define PARSE_CHUNK_MIN_SIZE (64 << 10)
+
+/**
+ * \def FORMAT_BLOCK_MIN_SIZE
+ * The smallest part of the text of a pixels matrix formatted by a thread of its own, in bytes.
+ */
+#define FORMAT_BLOCK_MIN_SIZE (64 << 10)
+
+/**
+ * \def CACHE_LINE_SIZE
+ * @brief The size of a cache line, the indexes of a ring written by different threads are kept this far apart.
+ */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * \def MAX_SAMPLE_TEXT_LEN
+ * @brief The maximum length of a written sample ("65535 ").
+ */
+#define MAX_SAMPLE_TEXT_LEN 6
+
+/**
+ * \def MAX_HEADER_TEXT_LEN
+ * @brief The maximum length of a written header ("P3\n4294967295 4294967295\n4294967295\n").
+ */
+#define MAX_HEADER_TEXT_LEN 36
+
+/**
+ * \def MAX_VALUE_TEXT_LEN
+ * @brief The width of the max color value field of a streamed ASCII header, the widest 16 bits value ("65535").
+ */
+#define MAX_VALUE_TEXT_LEN 5
+
+/**
+ * \def INDEX_EXTENSION
+ * @brief The suffix of the row index of an image ("image.ppm" is indexed by "image.ppm.idx").
+ */
+#define INDEX_EXTENSION ".idx"
+
+/**
+ * \def INDEX_MAGIC
+ * @brief The first bytes of a row index.
+ */
+#define INDEX_MAGIC "PNMIDX02"
+
+/**
+ * \def INDEX_HEADER_SIZE
+ * @brief The size of the header of a row index : the magic, the step and the number of lines (32 bits), the size of
+ *        the image (64 bits). The entries of the lines follow it, all the numbers are little-endian.
+ */
+#define INDEX_HEADER_SIZE 24
+
+/**
+ * \def INDEX_ENTRY_SIZE
+ * @brief The size of an entry of a row index : the offset of the line in the image and the check of its text (64 bits).
+ */
+#define INDEX_ENTRY_SIZE 16
+
+/**
+ * The magic numbers, indexed by MAGIC_NUMBERS.
+ */
+static const char *MAGIC_NUMBER_STRINGS[MAGIC_NUMBERS_COUNT] = {"P1", "P2", "P3", "P4", "P5", "P6"};
+
+/**
+ * The file extension matching each magic number, indexed by MAGIC_NUMBERS.
+ */
+static const char *MAGIC_NUMBER_EXTENSIONS[MAGIC_NUMBERS_COUNT] = {"pbm", "pgm", "ppm", "pbm", "pgm", "ppm"};
+
+/**
+ * The decimal representation of the numbers from 00 to 99.
+ */
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Enumeration of the ways a sample can be stored in the pixels matrix.
+ */
+typedef enum SAMPLE_WIDTH_t
+{
+    BIT_SAMPLES = 1,   /*!< 8 samples per byte, most significant bit first, lines padded to a byte (P1 and P4 images, as in a P4 file). */
+    BYTE_SAMPLES = 8,  /*!< One uint8_t per sample (maxPossibleValue <= 255). */
+    SHORT_SAMPLES = 16 /*!< One uint16_t per sample (the values written are the 16 low bits anyway). */
+} SAMPLE_WIDTH;
+
+/**
+ * \struct PNM_t
+ * \brief  Data structure representing a pnm image
+ */
+struct PNM_t
+{
+    MAGIC_NUMBERS magicNumber;     /*!< The magic number of the file (P1 to P6). */
+    unsigned int columns;          /*!< The quantity of columns / the length of a line. */
+    unsigned int lines;            /*!< The quantity of lines / the length of the pixels matrix. */
+    unsigned int maxPossibleValue; /*!< The maximum encoding value (in case of P2 / P3 / P5 / P6 file). */
+    SAMPLE_WIDTH sampleWidth;      /*!< The storage of the samples in the pixels matrix. */
+    unsigned char *pixels;         /*!< The matrix of pixels, line i begins at pixels + i * stride */
+    size_t stride;                 /*!< The number of bytes between the beginnings of two lines */
+};
+
+/**
+ * \struct ENCRYPTION_TASK_t
+ * \brief  The block of lines encrypted by one thread of encrypt_image().
+ */
+typedef struct ENCRYPTION_TASK_t
+{
+    PNM *image;                /*!< The image to encrypt. */
+    unsigned char *encrypted;  /*!< The 16 bits matrix receiving the encrypted samples. */
+    size_t encryptedStride;    /*!< The stride of the encrypted matrix. */
+    LFSR *lfsr;                /*!< The lfsr of the thread, positioned at the first sample of the block (NULL with a keystream). */
+    const uint32_t *keystream; /*!< The keystream of the whole image, NULL to generate it with lfsr. */
+    unsigned int firstLine;    /*!< The first line of the block. */
+    unsigned int endLine;      /*!< The line following the last line of the block. */
+    unsigned short maxValue;   /*!< The max (16 bits) value of the encrypted block. */
+} ENCRYPTION_TASK;
+
+/**
+ * \struct PARSE_TASK_t
+ * \brief  The chunk of an ASCII pixels matrix tokenized by one thread of store_pixels_parallel().
+ */
+typedef struct PARSE_TASK_t
+{
+    PNM *image;                 /*!< The image, its pixels matrix is created when the samples are stored. */
+    const unsigned char *begin; /*!< The first byte of the chunk, at the beginning of a line of the file. */
+    const unsigned char *end;   /*!< The byte following the chunk, at the beginning of a line of the file. */
+    size_t first;               /*!< The index in the image of the first sample of the chunk. */
+    size_t count;               /*!< The number of samples read in the chunk, up to its end or an error. */
+    int store;                  /*!< 0 to count the samples, 1 to store them in the pixels matrix. */
+    int malformed;              /*!< Set when something else than a sample or a comment is met. */
+    int overflow;               /*!< Set when a sample doesn't fit the storage of the matrix. */
+} PARSE_TASK;
+
+/**
+ * \struct RING_t
+ * \brief  Lock-free queue of bands between one producer thread and one consumer thread of the streaming pipeline.
+ */
+typedef struct RING_t
+{
+    PNM **slots;                                   /*!< The bands queued, slots[i % capacity] for head <= i < tail. */
+    size_t capacity;                               /*!< The number of slots. */
+    size_t head;                                   /*!< The number of bands popped, written by the consumer only. */
+    char headPadding[CACHE_LINE_SIZE - sizeof(size_t)];
+    size_t tail;                                   /*!< The number of bands pushed, written by the producer only. */
+    char tailPadding[CACHE_LINE_SIZE - sizeof(size_t)];
+} RING;
+
+/**
+ * \struct READER_t
+ * \brief  Buffered reader used to tokenize the ASCII content of a pnm file.
+ */
+typedef struct READER_t
+{
+    FILE *file;             /*!< The file to read, NULL once the whole content is in buffer. */
+    unsigned char *buffer;  /*!< The bytes read and not consumed yet. */
+    size_t size;            /*!< The number of bytes in buffer. */
+    size_t position;        /*!< The index of the next byte to consume in buffer. */
+    unsigned char *mapping; /*!< The file mapped in memory (buffer is then a window of it), NULL for a buffered read. */
+    size_t mappingSize;     /*!< The size of the mapping. */
+} READER;
+
+/**
+ * \fn static int open_reader(READER *reader, FILE *file)
+ * \brief Initialize a reader on a file, mapped in memory when it is a regular file.
+ *
+ * \param reader The reader.
+ * \param file The file to read.
+ *
+ * \pre reader is instanced, file is instanced.
+ * \post The reader is ready, it has to be released with close_reader().
+ *
+ * \return int 0 Error in memory allocation
+ *             1 Success
+ */
+static int open_reader(READER *reader, FILE *file)
+{
+    assert(reader && file);
+    reader->file = file;
+    reader->size = 0;
+    reader->position = 0;
+    reader->mapping = NULL;
+
+    // a regular file is parsed straight from its mapping, a pipe or a device goes through the buffer
+    struct stat fileStatus;
+    if (fstat(fileno(file), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) && fileStatus.st_size > 0)
+    {
+        void *mapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, (size_t)fileStatus.st_size, MADV_SEQUENTIAL);
+            reader->mapping = mapping;
+            reader->mappingSize = (size_t)fileStatus.st_size;
+            reader->buffer = mapping;
+            reader->size = reader->mappingSize < READER_MAPPING_WINDOW ? reader->mappingSize : READER_MAPPING_WINDOW;
+            reader->file = NULL;
+            return 1;
+        }
+    }
+
+    reader->buffer = malloc(READER_BUFFER_SIZE);
+    return reader->buffer != NULL;
+} // end open_reader()
+
+/**
+ * \fn static void close_reader(READER *reader)
+ * \brief Release the buffer or the mapping of a reader (the file is not closed).
+ *
+ * \param reader The reader.
+ *
+ * \pre reader is instanced.
+ * \post The buffer is frees.
+ */
+static void close_reader(READER *reader)
+{
+    assert(reader);
+    if (reader->mapping)
+    {
+        munmap(reader->mapping, reader->mappingSize);
+        reader->mapping = NULL;
+    }
+    else
+    {
+        free(reader->buffer);
+    }
+    reader->buffer = NULL;
+} // end close_reader()
+
+/**
+ * \fn static void close_input(FILE *file)
+ * \brief Close the file of an image, the standard input is left open.
+ *
+ * \param file The file.
+ *
+ * \pre file is instanced.
+ * \post The file is closed, unless it is stdin.
+ */
+static void close_input(FILE *file)
+{
+    if (file != stdin)
+    {
+        fclose(file);
+    }
+} // end close_input()
+
+/**
+ * \fn static int close_output(int fd)
+ * \brief Close the file descriptor of an image, the standard output is left open.
+ *
+ * \param fd The file descriptor.
+ *
+ * \return int 0 Success
+ *             -1 Error of file manipulation
+ */
+static int close_output(int fd)
+{
+    return fd == STDOUT_FILENO ? 0 : close(fd);
+} // end close_output()
+
+/**
+ * \fn static int refill_reader(READER *reader)
+ * \brief Replace the consumed content of the buffer by the next bytes of the file.
+ *
+ * \param reader The reader.
+ *
+ * \pre reader is instanced, reader->position == reader->size.
+ * \post The buffer holds the next bytes of the file, if any.
+ *
+ * \return int 0 End of file
+ *             1 Success
+ */
+static int refill_reader(READER *reader)
+{
+    if (reader->mapping)
+    {
+        size_t consumed = (size_t)(reader->buffer - reader->mapping) + reader->size;
+        if (consumed >= reader->mappingSize)
+        {
+            return 0;
+        }
+        // the consumed window won't be read again, keep it out of the resident set
+        madvise(reader->buffer, reader->size, MADV_DONTNEED);
+        reader->buffer = reader->mapping + consumed;
+        reader->size = reader->mappingSize - consumed < READER_MAPPING_WINDOW ? reader->mappingSize - consumed : READER_MAPPING_WINDOW;
+        reader->position = 0;
+        return 1;
+    }
+    if (!reader->file)
+    {
+        return 0;
+    }
+    reader->size = fread(reader->buffer, 1, READER_BUFFER_SIZE, reader->file);
+    reader->position = 0;
+    return reader->size > 0;
+} // end refill_reader()
+
+/**
+ * \fn static inline int peek_reader(READER *reader)
+ * \brief Get the next byte of a reader without consuming it.
+ *
+ * \param reader The reader.
+ *
+ * \pre reader is instanced.
+ * \post The next byte is returned.
+ *
+ * \return int The byte.
+ *              EOF at the end of the content.
+ */
+static inline int peek_reader(READER *reader)
+{
+    if (reader->position == reader->size && !refill_reader(reader))
+    {
+        return EOF;
+    }
+    return reader->buffer[reader->position];
+} // end peek_reader()
+
+/**
+ * \fn static int go_to_next_data(READER *reader, unsigned int *breakPointLine)
+ * \brief Go to the first visible character (i.e. not [' ', '\n', '\r', '', '\t',...] ) wich isn't in a commented area.
+ *
+ * \param reader The reader to iterate into.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre reader is instanced, breakPointLine is instanced.
+ * \post The playhead points to the next uncommented area.
+ *
+ * \return int 0 error
+ *             1 success
+ */
+static int go_to_next_data(READER *reader, unsigned int *breakPointLine)
+{
+    assert(reader && breakPointLine);
+    int inComment = 0;
+
+    while (1)
+    {
+        int character = peek_reader(reader);
+        if (character == EOF)
+        {
+            return 0;
+        }
+        if (character == '\n' || character == '\r')
+        {
+            (*breakPointLine)++;
+            inComment = 0;
+        }
+        else if (!inComment && character == '#')
+        {
+            inComment = 1;
+        }
+        else if (!inComment && isgraph(character))
+        {
+            return 1;
+        }
+        reader->position++;
+    }
+} // end go_to_next_data()
+
+/**
+ * \fn static int read_unsigned(READER *reader, unsigned int *value)
+ * \brief Parse the unsigned integer at the playhead (with the wrap around of scanf("%u") for a '-' sign).
+ *
+ * \param reader The reader.
+ * \param value The address where to write the integer.
+ *
+ * \pre reader is instanced, value is instanced.
+ * \post The playhead points after the integer.
+ *
+ * \return int 0 No integer at the playhead
+ *             1 Success
+ */
+static int read_unsigned(READER *reader, unsigned int *value)
+{
+    assert(reader && value);
+    int character = peek_reader(reader);
+    int negative = character == '-';
+    if (character == '-' || character == '+')
+    {
+        reader->position++;
+        character = peek_reader(reader);
+    }
+    if (character < '0' || character > '9')
+    {
+        return 0;
+    }
+
+    unsigned int result = 0;
+    do
+    {
+        result = result * 10 + (unsigned int)(character - '0');
+        reader->position++;
+        character = peek_reader(reader);
+    } while (character >= '0' && character <= '9');
+
+    *value = negative ? 0u - result : result;
+    return 1;
+} // end read_unsigned()
+
+/**
+ * \fn static int read_bytes(READER *reader, unsigned char *out, size_t n)
+ * \brief Copy the next bytes of a reader.
+ *
+ * \param reader The reader.
+ * \param out The address where to copy the bytes.
+ * \param n The number of bytes to copy.
+ *
+ * \pre reader is instanced, out can hold n bytes.
+ * \post The playhead points after the bytes.
+ *
+ * \return int 0 End of file reached before n bytes
+ *             1 Success
+ */
+static int read_bytes(READER *reader, unsigned char *out, size_t n)
+{
+    assert(reader && (out || n == 0));
+    while (n > 0)
+    {
+        if (reader->position == reader->size && !refill_reader(reader))
+        {
+            return 0;
+        }
+        size_t available = reader->size - reader->position;
+        size_t chunk = n < available ? n : available;
+        memcpy(out, reader->buffer + reader->position, chunk);
+        reader->position += chunk;
+        out += chunk;
+        n -= chunk;
+    }
+    return 1;
+} // end read_bytes()
+
+/**
+ * \fn static int seek_reader(READER *reader, size_t offset)
+ * \brief Move the playhead of a reader on a mapped file to a byte of the file.
+ *
+ * \param reader The reader.
+ * \param offset The position of the byte in the file.
+ *
+ * \pre reader is instanced.
+ * \post The playhead points to the byte.
+ *
+ * \return int 0 The file isn't mapped or is shorter than offset
+ *             1 Success
+ */
+static int seek_reader(READER *reader, size_t offset)
+{
+    assert(reader);
+    if (!reader->mapping || offset > reader->mappingSize)
+    {
+        return 0;
+    }
+    reader->buffer = reader->mapping + offset;
+    reader->size = reader->mappingSize - offset < READER_MAPPING_WINDOW ? reader->mappingSize - offset : READER_MAPPING_WINDOW;
+    reader->position = 0;
+    return 1;
+} // end seek_reader()
+
+/**
+ * \fn static int skip_bytes(READER *reader, size_t n)
+ * \brief Consume the next bytes of a reader without copying them (a mapped file is not even read).
+ *
+ * \param reader The reader.
+ * \param n The number of bytes to skip.
+ *
+ * \pre reader is instanced.
+ * \post The playhead points after the bytes.
+ *
+ * \return int 0 End of file reached before n bytes
+ *             1 Success
+ */
+static int skip_bytes(READER *reader, size_t n)
+{
+    assert(reader);
+    if (reader->mapping)
+    {
+        // the window is moved straight to the byte following the skipped ones
+        return seek_reader(reader, (size_t)(reader->buffer - reader->mapping) + reader->position + n);
+    }
+    while (n > 0)
+    {
+        if (reader->position == reader->size && !refill_reader(reader))
+        {
+            return 0;
+        }
+        size_t available = reader->size - reader->position;
+        size_t chunk = n < available ? n : available;
+        reader->position += chunk;
+        n -= chunk;
+    }
+    return 1;
+} // end skip_bytes()
+
+/**
+ * \fn static int is_binary(MAGIC_NUMBERS magicNumber)
+ * \brief Tell whether the pixels matrix of a format is stored in binary.
+ *
+ * \param magicNumber The magic number of the format.
+ *
+ * \return int 1 for P4, P5 and P6
+ *             0 for P1, P2 and P3
+ */
+static int is_binary(MAGIC_NUMBERS magicNumber)
+{
+    return magicNumber == P4 || magicNumber == P5 || magicNumber == P6;
+} // end is_binary()
+
+/**
+ * \fn static int has_max_value(MAGIC_NUMBERS magicNumber)
+ * \brief Tell whether the header of a format holds a max color value.
+ *
+ * \param magicNumber The magic number of the format.
+ *
+ * \return int 1 for everything but the bitmaps (P1 and P4)
+ *             0 for the bitmaps
+ */
+static int has_max_value(MAGIC_NUMBERS magicNumber)
+{
+    return magicNumber != P1 && magicNumber != P4;
+} // end has_max_value()
+
+/**
+ * \fn static unsigned int samples_per_line(PNM *image)
+ * \brief Get the number of samples in a line of the pixels matrix.
+ *
+ * \param image The image.
+ *
+ * \pre image is instanced.
+ * \post The number of samples is returned.
+ *
+ * \return unsigned int The number of samples (3 per pixel for P3 and P6, 1 otherwise).
+ */
+static unsigned int samples_per_line(PNM *image)
+{
+    if (image->magicNumber == P3 || image->magicNumber == P6)
+    {
+        return image->columns * 3;
+    }
+    return image->columns;
+} // end samples_per_line()
+
+/**
+ * \fn static size_t line_size(SAMPLE_WIDTH sampleWidth, unsigned int samples)
+ * \brief Get the number of bytes needed to store a line.
+ *
+ * \param sampleWidth The storage of the samples.
+ * \param samples The number of samples in the line.
+ *
+ * \return size_t The size of the line in bytes.
+ */
+static size_t line_size(SAMPLE_WIDTH sampleWidth, unsigned int samples)
+{
+    switch (sampleWidth)
+    {
+    case BIT_SAMPLES:
+        return ((size_t)samples + 7) / 8;
+    case BYTE_SAMPLES:
+        return (size_t)samples;
+    default:
+        return (size_t)samples * sizeof(uint16_t);
+    }
+} // end line_size()
+
+/**
+ * \fn static inline unsigned char *pixels_line(PNM *image, unsigned int line)
+ * \brief Get the beginning of a line of the pixels matrix.
+ *
+ * \param image The image.
+ * \param line The index of the line.
+ *
+ * \pre image is instanced, image->pixels is instanced, line < image->lines.
+ * \post The address of the first byte of the line is returned.
+ *
+ * \return unsigned char* The line.
+ */
+static inline unsigned char *pixels_line(PNM *image, unsigned int line)
+{
+    return image->pixels + (size_t)line * image->stride;
+} // end pixels_line()
+
+/**
+ * \fn static inline unsigned int read_sample(const unsigned char *line, SAMPLE_WIDTH sampleWidth, unsigned int j)
+ * \brief Read a sample of a line.
+ *
+ * \param line The line.
+ * \param sampleWidth The storage of the samples.
+ * \param j The index of the sample.
+ *
+ * \return unsigned int The sample.
+ */
+static inline unsigned int read_sample(const unsigned char *line, SAMPLE_WIDTH sampleWidth, unsigned int j)
+{
+    switch (sampleWidth)
+    {
+    case BIT_SAMPLES:
+        return (line[j / 8] >> (7 - j % 8)) & 1;
+    case BYTE_SAMPLES:
+        return line[j];
+    default:
+        return ((const uint16_t *)line)[j];
+    }
+} // end read_sample()
+
+/**
+ * \fn static inline void write_sample(unsigned char *line, SAMPLE_WIDTH sampleWidth, unsigned int j, unsigned int value)
+ * \brief Write a sample of a line.
+ *
+ * \param line The line.
+ * \param sampleWidth The storage of the samples.
+ * \param j The index of the sample.
+ * \param value The sample, it has to fit in sampleWidth bits.
+ */
+static inline void write_sample(unsigned char *line, SAMPLE_WIDTH sampleWidth, unsigned int j, unsigned int value)
+{
+    switch (sampleWidth)
+    {
+    case BIT_SAMPLES:
+        line[j / 8] = (unsigned char)((line[j / 8] & ~(0x80 >> j % 8)) | (value << (7 - j % 8)));
+        break;
+    case BYTE_SAMPLES:
+        line[j] = (unsigned char)value;
+        break;
+    default:
+        ((uint16_t *)line)[j] = (uint16_t)value;
+        break;
+    }
+} // end write_sample()
+
+/**
+ * \fn static int widen_pixels(PNM *image, unsigned int linesUsed)
+ * \brief Convert the pixels matrix to 16 bits samples.
+ *
+ * \param image The image.
+ * \param linesUsed The number of lines (from the top) holding samples to keep.
+ *
+ * \pre image is instanced, image->pixels is instanced.
+ * \post The samples of the linesUsed first lines are stored in 16 bits.
+ *
+ * \return int 0 Error in memory allocation (the matrix is left unchanged)
+ *             1 Success
+ */
+static int widen_pixels(PNM *image, unsigned int linesUsed)
+{
+    unsigned int columns = samples_per_line(image);
+    size_t stride;
+    unsigned char *pixels = create_matrix(image->lines, line_size(SHORT_SAMPLES, columns), &stride);
+    if (!pixels)
+    {
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < linesUsed; i++)
+    {
+        unsigned char *source = pixels_line(image, i);
+        uint16_t *destination = (uint16_t *)(pixels + (size_t)i * stride);
+        for (unsigned int j = 0; j < columns; j++)
+        {
+            destination[j] = (uint16_t)read_sample(source, image->sampleWidth, j);
+        }
+    }
+
+    free_matrix(image->pixels);
+    image->pixels = pixels;
+    image->stride = stride;
+    image->sampleWidth = SHORT_SAMPLES;
+    return 1;
+} // end widen_pixels()
+
+/**
+ * \fn static SAMPLE_WIDTH header_sample_width(PNM *image)
+ * \brief Get the storage of the samples announced by the header of an image.
+ *
+ * \param image The image, its magic number and max color value are set.
+ *
+ * \return SAMPLE_WIDTH Bits for a bitmap, bytes for a max color value <= 255, shorts otherwise.
+ */
+static SAMPLE_WIDTH header_sample_width(PNM *image)
+{
+    if (!has_max_value(image->magicNumber))
+    {
+        return BIT_SAMPLES;
+    }
+    if (image->maxPossibleValue <= UINT8_MAX)
+    {
+        return BYTE_SAMPLES;
+    }
+    return SHORT_SAMPLES;
+} // end header_sample_width()
+
+/**
+ * \fn static int read_raw_separator(READER *imageFile, PNM *image, unsigned int *breakPointLine)
+ * \brief Check the max color value of a binary image and consume the whitespace ending its header.
+ *
+ * \param imageFile The reader on the file, its playhead is on the whitespace ending the header.
+ * \param image The image struct, its header is set.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre imageFile is instanced, image is instanced.
+ * \post The playhead points to the first byte of the binary pixels matrix.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int read_raw_separator(READER *imageFile, PNM *image, unsigned int *breakPointLine)
+{
+    assert(imageFile && image && breakPointLine);
+
+    if (has_max_value(image->magicNumber) && (image->maxPossibleValue == 0 || image->maxPossibleValue > UINT16_MAX))
+    {
+        fprintf(get_messages_stream(), "> 🔴 The max color value of a binary image has to be in [1, 65535].\n");
+        return 0;
+    }
+    int separator = peek_reader(imageFile);
+    if (separator == EOF || !isspace(separator))
+    {
+        fprintf(get_messages_stream(), "> 🔴 The header has to end with a single whitespace.\n");
+        return 0;
+    }
+    if (separator == '\n' || separator == '\r')
+    {
+        (*breakPointLine)++;
+    }
+    imageFile->position++;
+    return 1;
+} // end read_raw_separator()
+
+/**
+ * \fn static int store_raw_line(READER *imageFile, PNM *image, unsigned int i, unsigned int matrixLine)
+ * \brief Store the next line of a binary pixels matrix (P4, P5, P6) in a line of a PNM structure.
+ *
+ * \param imageFile The reader on the file.
+ * \param image The image struct, its pixels matrix is created.
+ * \param i The index of the line to fill in.
+ * \param matrixLine The index of the line in the matrix of the file (for the error messages).
+ *
+ * \pre imageFile is instanced, image is instanced, i < image->lines.
+ * \post The line is stored, 16 bits samples are converted from big-endian.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int store_raw_line(READER *imageFile, PNM *image, unsigned int i, unsigned int matrixLine)
+{
+    unsigned int linesLength = samples_per_line(image);
+    unsigned char *line = pixels_line(image, i);
+    if (!read_bytes(imageFile, line, line_size(image->sampleWidth, linesLength)))
+    {
+        fprintf(get_messages_stream(), "> 🔴 No more pixels to read. Line reached in the matrix : [%d].\n", matrixLine + 1);
+        return 0;
+    }
+    if (image->sampleWidth == SHORT_SAMPLES)
+    {
+        uint16_t *samples = (uint16_t *)line;
+        for (unsigned int j = 0; j < linesLength; j++)
+        {
+            samples[j] = (uint16_t)(line[2 * j] << 8 | line[2 * j + 1]);
+        }
+    }
+    return 1;
+} // end store_raw_line()
+
+/**
+ * \fn static int store_raw_pixels(READER *imageFile, PNM *image, unsigned int *breakPointLine)
+ * \brief Store the binary pixels matrix (P4, P5, P6) found in a file in a PNM structure.
+ *
+ * \param imageFile The reader on the file, its playhead is on the whitespace ending the header.
+ * \param image The image struct.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre imageFile is instanced, image is instanced.
+ * \post The matrix is store, 16 bits samples are converted from big-endian.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int store_raw_pixels(READER *imageFile, PNM *image, unsigned int *breakPointLine)
+{
+    assert(imageFile && image && breakPointLine);
+
+    // Step 1 : a single whitespace separates the header from the matrix
+    if (!read_raw_separator(imageFile, image, breakPointLine))
+    {
+        return 0;
+    } // end Step 1
+
+    // Step 2 : creation of the pixels matrix
+    image->sampleWidth = header_sample_width(image);
+    if (!(image->pixels = create_matrix(image->lines, line_size(image->sampleWidth, samples_per_line(image)), &image->stride)))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate the required memory space to store the image.\n");
+        return 0;
+    } // end Step 2
+
+    // Step 3 : copy the lines
+    for (unsigned int i = 0; i < image->lines; i++)
+    {
+        if (!store_raw_line(imageFile, image, i, i))
+        {
+            return 0;
+        }
+    } // end Step 3
+
+    return 1;
+} // end store_raw_pixels()
+
+/**
+ * \fn static int store_line(READER *imageFile, PNM *image, unsigned int i, unsigned int matrixLine, unsigned int *breakPointLine)
+ * \brief Store the next line of an ASCII pixels matrix (P1, P2, P3) in a line of a PNM structure.
+ *
+ * \param imageFile The reader on the file.
+ * \param image The image struct, its pixels matrix is created.
+ * \param i The index of the line to fill in.
+ * \param matrixLine The index of the line in the matrix of the file (for the error messages).
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre imageFile is instanced, image is instanced, i < image->lines.
+ * \post The line is stored, the matrix is widened to 16 bits if a sample doesn't fit in it.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int store_line(READER *imageFile, PNM *image, unsigned int i, unsigned int matrixLine, unsigned int *breakPointLine)
+{
+    unsigned int linesLength = samples_per_line(image);
+    for (unsigned int j = 0; j < linesLength; j++)
+    {
+        unsigned int value;
+        if (!go_to_next_data(imageFile, breakPointLine))
+        {
+            fprintf(get_messages_stream(), "> 🔴 No more pixels to read. Position reached in the matrix : [%d, %d].\n", matrixLine + 1, j + 1);
+            return 0;
+        }
+        if (!read_unsigned(imageFile, &value))
+        {
+            fprintf(get_messages_stream(), "> 🔴 No number to read. Position reached in the matrix : [%d, %d].\n", matrixLine + 1, j + 1);
+            return 0;
+        }
+        // an encrypted file holds 16 bits samples whatever its header says
+        if (value >> image->sampleWidth && image->sampleWidth != SHORT_SAMPLES && !widen_pixels(image, i + 1))
+        {
+            fprintf(get_messages_stream(), "> 🔴 Unable to allocate the required memory space to store the image.\n");
+            return 0;
+        }
+        write_sample(pixels_line(image, i), image->sampleWidth, j, (unsigned short)value);
+    }
+    return 1;
+} // end store_line()
+
+/**
+ * \fn static int store_pixels(READER* imageFile, PNM** image, unsigned int* breakPointLine)
+ * \brief Store the pixels matrix found in a file in a PNM structure.
+ *
+ * \param imageFile The reader on the file.
+ * \param image The image struct.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre fp is instanced, image is instanced.
+ * \post The matrix is store.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int store_pixels(READER *imageFile, PNM **image, unsigned int *breakPointLine)
+{
+    assert(imageFile && image);
+
+    // Step 1 : creation of the pixels matrix, with the narrowest storage the header allows
+    (*image)->sampleWidth = header_sample_width(*image);
+    if (!((*image)->pixels = create_matrix((*image)->lines, line_size((*image)->sampleWidth, samples_per_line(*image)), &(*image)->stride)))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate the required memory space to store the image.\n");
+        return 0;
+    } // end Step 1
+
+    // Step 2 : fill in the pixels matrix
+    for (unsigned int i = 0; i < (*image)->lines; i++)
+    {
+        if (!store_line(imageFile, *image, i, i, breakPointLine))
+        {
+            return 0;
+        }
+    } // end Step 2
+
+    return 1;
+} // end store_pixels()
+
+/**
+ * \fn static void *parse_chunk(void *task)
+ * \brief Thread routine of store_pixels_parallel() : count or store the samples of a chunk, with the tokens of
+ *        go_to_next_data() and read_unsigned().
+ *
+ * \param task The PARSE_TASK to process.
+ *
+ * \pre task is instanced, a chunk stored has its first sample set and holds no error before the last sample of the image.
+ * \post task->count, task->malformed and task->overflow are set, the samples are stored if task->store.
+ *
+ * \return void* NULL.
+ */
+static void *parse_chunk(void *task)
+{
+    PARSE_TASK *chunk = task;
+    PNM *image = chunk->image;
+    unsigned int linesLength = samples_per_line(image);
+    size_t total = (size_t)image->lines * linesLength;
+    unsigned int line = (unsigned int)(chunk->first / linesLength);
+    unsigned int j = (unsigned int)(chunk->first % linesLength);
+    const unsigned char *p = chunk->begin;
+    const unsigned char *end = chunk->end;
+    chunk->count = 0;
+    chunk->malformed = 0;
+    chunk->overflow = 0;
+
+    while (p < end && (!chunk->store || chunk->first + chunk->count < total))
+    {
+        // a comment ends with the line, the chunk begins out of any comment
+        if (*p == '#')
+        {
+            while (p < end && *p != '\n' && *p != '\r')
+            {
+                p++;
+            }
+            continue;
+        }
+        if (!isgraph(*p))
+        {
+            p++;
+            continue;
+        }
+
+        int negative = *p == '-';
+        if (*p == '-' || *p == '+')
+        {
+            p++;
+        }
+        if (p == end || *p < '0' || *p > '9')
+        {
+            chunk->malformed = 1;
+            return NULL;
+        }
+        // counting the samples only needs their ends
+        if (!chunk->store)
+        {
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                p++;
+            }
+            chunk->count++;
+            continue;
+        }
+        unsigned int value = 0;
+        do
+        {
+            value = value * 10 + (unsigned int)(*p - '0');
+            p++;
+        } while (p < end && *p >= '0' && *p <= '9');
+        value = negative ? 0u - value : value;
+
+        if (value >> image->sampleWidth && image->sampleWidth != SHORT_SAMPLES)
+        {
+            chunk->overflow = 1;
+            return NULL;
+        }
+        write_sample(pixels_line(image, line), image->sampleWidth, j, (unsigned short)value);
+        if (++j == linesLength)
+        {
+            j = 0;
+            line++;
+        }
+        chunk->count++;
+    }
+    return NULL;
+} // end parse_chunk()
+
+/**
+ * \fn static void run_workers(void *(*worker)(void *), void *tasks, size_t taskSize, unsigned int count, pthread_t *threads, int *started)
+ * \brief Run a thread routine on every task of an array, one thread per task (the caller takes the first task, and
+ *        the ones whose thread can't be started).
+ *
+ * \param worker The thread routine.
+ * \param tasks The tasks.
+ * \param taskSize The size of a task.
+ * \param count The number of tasks.
+ * \param threads The threads, one per task.
+ * \param started The started flags, one per task.
+ *
+ * \pre tasks, threads and started hold count elements, count > 0.
+ * \post Every task is processed.
+ */
+static void run_workers(void *(*worker)(void *), void *tasks, size_t taskSize, unsigned int count, pthread_t *threads, int *started)
+{
+    char *task = tasks;
+    for (unsigned int t = 1; t < count; t++)
+    {
+        started[t] = pthread_create(&threads[t], NULL, worker, task + t * taskSize) == 0;
+        if (!started[t])
+        {
+            worker(task + t * taskSize);
+        }
+    }
+    worker(task);
+    for (unsigned int t = 1; t < count; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(threads[t], NULL);
+        }
+    }
+} // end run_workers()
+
+/**
+ * \fn static void run_parse_tasks(PARSE_TASK *tasks, pthread_t *threads, int *started, unsigned int chunks, int store)
+ * \brief Run parse_chunk() on every chunk, one thread per chunk.
+ *
+ * \param tasks The chunks.
+ * \param threads The threads, one per chunk.
+ * \param started The started flags, one per chunk.
+ * \param chunks The number of chunks.
+ * \param store 0 to count the samples, 1 to store them.
+ *
+ * \pre tasks, threads and started hold chunks elements.
+ * \post Every chunk is processed.
+ */
+static void run_parse_tasks(PARSE_TASK *tasks, pthread_t *threads, int *started, unsigned int chunks, int store)
+{
+    for (unsigned int t = 0; t < chunks; t++)
+    {
+        tasks[t].store = store;
+    }
+    run_workers(parse_chunk, tasks, sizeof(PARSE_TASK), chunks, threads, started);
+} // end run_parse_tasks()
+
+/**
+ * \fn static int store_pixels_parallel(READER *imageFile, PNM *image, unsigned int threadsCount)
+ * \brief Store the ASCII pixels matrix (P2, P3) of a mapped file in a PNM structure, on several threads.
+ *
+ * The matrix is split in chunks ending at a line break, so that none begins inside a comment or a number. The
+ * samples of each chunk are counted, a prefix sum of the counts gives the index of the first sample of each chunk,
+ * then the chunks are tokenized again to store their samples at their place.
+ *
+ * \param imageFile The reader on the file, its playhead is after the header.
+ * \param image The image struct, its header is set.
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre imageFile is instanced, image is instanced, threadsCount > 0.
+ * \post The matrix is stored, or the image and the reader are left unchanged.
+ *
+ * \return int 0 Not stored (the file isn't mapped or too small, an error is found or memory lacks) : the
+ *               sequential store_pixels() has to be used, it reports the errors
+ *             1 Success
+ */
+static int store_pixels_parallel(READER *imageFile, PNM *image, unsigned int threadsCount)
+{
+    assert(imageFile && image && threadsCount > 0);
+    size_t total = (size_t)image->lines * samples_per_line(image);
+    if (!imageFile->mapping || image->magicNumber == P1 || total == 0)
+    {
+        return 0;
+    }
+    const unsigned char *begin = imageFile->buffer + imageFile->position;
+    const unsigned char *end = imageFile->mapping + imageFile->mappingSize;
+    size_t size = (size_t)(end - begin);
+    if (size / PARSE_CHUNK_MIN_SIZE < threadsCount)
+    {
+        threadsCount = (unsigned int)(size / PARSE_CHUNK_MIN_SIZE);
+    }
+    if (threadsCount < 2)
+    {
+        return 0;
+    }
+
+    PARSE_TASK *tasks = calloc(threadsCount, sizeof(PARSE_TASK));
+    pthread_t *threads = malloc(threadsCount * sizeof(pthread_t));
+    int *started = calloc(threadsCount, sizeof(int));
+    int success = tasks && threads && started;
+
+    // Step 1 : split the matrix at the first line break following each share of its size
+    unsigned int chunks = 0;
+    const unsigned char *chunkBegin = begin;
+    for (unsigned int t = 1; success && t <= threadsCount && chunkBegin < end; t++)
+    {
+        const unsigned char *chunkEnd = t == threadsCount ? end : begin + (size_t)((uint64_t)size * t / threadsCount);
+        if (chunkEnd < chunkBegin)
+        {
+            chunkEnd = chunkBegin;
+        }
+        while (chunkEnd < end && *chunkEnd != '\n' && *chunkEnd != '\r')
+        {
+            chunkEnd++;
+        }
+        if (chunkEnd < end)
+        {
+            chunkEnd++;
+        }
+        tasks[chunks].image = image;
+        tasks[chunks].begin = chunkBegin;
+        tasks[chunks].end = chunkEnd;
+        chunks++;
+        chunkBegin = chunkEnd;
+    } // end Step 1
+
+    // Step 2 : count the samples of the chunks, their prefix sum places the chunks in the image
+    if (success)
+    {
+        run_parse_tasks(tasks, threads, started, chunks, 0);
+        size_t first = 0;
+        unsigned int used = 0;
+        for (; used < chunks && first < total; used++)
+        {
+            tasks[used].first = first;
+            // an error after the last sample is ignored, as the sequential parsing never reaches it
+            if (tasks[used].malformed && first + tasks[used].count < total)
+            {
+                success = 0;
+                break;
+            }
+            first += tasks[used].count;
+        }
+        chunks = used;
+        success = success && first >= total;
+    } // end Step 2
+
+    // Step 3 : store the samples, in 16 bits if one of them doesn't fit the storage announced by the header
+    if (success)
+    {
+        image->sampleWidth = header_sample_width(image);
+        image->pixels = create_matrix(image->lines, line_size(image->sampleWidth, samples_per_line(image)), &image->stride);
+        success = image->pixels != NULL;
+    }
+    int overflow = success;
+    while (overflow)
+    {
+        run_parse_tasks(tasks, threads, started, chunks, 1);
+        overflow = 0;
+        for (unsigned int t = 0; t < chunks; t++)
+        {
+            overflow |= tasks[t].overflow;
+        }
+        if (overflow && !widen_pixels(image, 0))
+        {
+            overflow = 0;
+            success = 0;
+        }
+    }
+    if (!success && image->pixels)
+    {
+        free_matrix(image->pixels);
+        image->pixels = NULL;
+    } // end Step 3
+
+    free(tasks);
+    free(threads);
+    free(started);
+    return success;
+} // end store_pixels_parallel()
+
+/**
+ * \fn static int read_header(READER *reader, PNM *image, char *extension, unsigned int *breakPointLine)
+ * \brief Read the header of a pnm file (magic number, number of columns and lines, max color value).
+ *
+ * \param reader The reader on the file, its playhead is at the beginning of the file.
+ * \param image The image struct receiving the header.
+ * \param extension The extension of the file name, NULL to take the format from the magic number only (standard input).
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre reader is instanced, image is instanced, extension is instanced, breakPointLine is instanced.
+ * \post The playhead points after the header.
+ *
+ * \return int 0 Success
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ */
+static int read_header(READER *reader, PNM *image, char *extension, unsigned int *breakPointLine)
+{
+    assert(reader && image && breakPointLine);
+    image->maxPossibleValue = 1;
+
+    // step 1 : store magic number
+    char magicNumberString[MAGIC_NUMBER_LEN];
+
+    if (!go_to_next_data(reader, breakPointLine))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to continue file read after magic number.\n");
+        return -3;
+    }
+    if (*breakPointLine > 1)
+    {
+        fprintf(get_messages_stream(), "> 🔴 The file have to begin with the magic number at line 1\n");
+        return -3;
+    }
+    unsigned int magicNumberLength = 0;
+    while (magicNumberLength < MAGIC_NUMBER_LEN - 1 && peek_reader(reader) != EOF && peek_reader(reader) != '#')
+    {
+        magicNumberString[magicNumberLength++] = (char)reader->buffer[reader->position++];
+    }
+    magicNumberString[magicNumberLength] = '\0';
+    if (magicNumberLength == 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to find a string at line 1.\n");
+        return -3;
+    } // end step 1
+
+    // step 2 - compare magic number with fil extension
+    int magicNumberIndex = -1;
+    for (int k = 0; k < MAGIC_NUMBERS_COUNT; k++)
+    {
+        if (strcmp(magicNumberString, MAGIC_NUMBER_STRINGS[k]) == 0)
+        {
+            magicNumberIndex = k;
+        }
+    }
+    if (magicNumberIndex < 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 The magic number is unknown. Magic number found : [%s]\n", magicNumberString);
+        return -3;
+    }
+    if (extension && strcmp(extension, MAGIC_NUMBER_EXTENSIONS[magicNumberIndex]) != 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 file extension [%s] does not match the magic number [%s].\n", extension, magicNumberString);
+        return -2;
+    }
+    image->magicNumber = (MAGIC_NUMBERS)magicNumberIndex;
+    // end step 2
+
+    // step 3 - Store number of columns and lines
+    if (!go_to_next_data(reader, breakPointLine))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to continue file read after magic number.\n");
+        return -3;
+    }
+    if (!read_unsigned(reader, &image->columns) || !go_to_next_data(reader, breakPointLine) || !read_unsigned(reader, &image->lines))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to find the number of columns and lines.\n");
+        return -3;
+    }
+    // end step 3
+
+    // step 4 - Store the max color value
+    if (has_max_value(image->magicNumber))
+    {
+        if (!go_to_next_data(reader, breakPointLine))
+        {
+            fprintf(get_messages_stream(), "> 🔴 Unable to continue file read after max color value\n");
+            return -3;
+        }
+        if (!read_unsigned(reader, &image->maxPossibleValue))
+        {
+            fprintf(get_messages_stream(), "> 🔴 Unable to find the max color value.\n");
+            return -3;
+        }
+    } // end step 4
+
+    return 0;
+} // end read_header()
+
+int load_pnm(PNM **image, char *filename)
+{
+    return load_pnm_parallel(image, filename, 1);
+} // end load_pnm()
+
+int load_pnm_parallel(PNM **image, char *filename, unsigned int threadsCount)
+{
+    assert(image != NULL && filename != NULL && threadsCount > 0);
+
+    // step 1 - checking for the file name extension and compare it with the magic number, "-" has none
+    char *extension = NULL;
+    int standardInput = is_standard_stream(filename);
+    if (!standardInput && !(extension = get_file_extension(filename)))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to get the file extension: [%s]\n", filename);
+        return -2;
+    } // end step 1
+
+    // step 2 - Open the file
+    FILE *imageFile = NULL;
+    imageFile = standardInput ? stdin : fopen(filename, "r");
+    if (!imageFile)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to open the file [%s].\n", filename);
+        return -1;
+    }
+    READER reader;
+    if (!open_reader(&reader, imageFile))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to read the file.\n");
+        close_input(imageFile);
+        return -1;
+    } // end step 2
+
+    // step 3 - create the pnm instance
+    *image = malloc(sizeof(PNM));
+    if (!(*image))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space for the image.\n");
+        close_reader(&reader);
+        close_input(imageFile);
+        return -1;
+    }
+    (*image)->pixels = NULL;
+    // end step 3
+
+    // step 4 - magic number, number of columns and lines, max color value
+    unsigned int breakPointLine = 1;
+    int headerStatus = read_header(&reader, *image, extension, &breakPointLine);
+    if (headerStatus != 0)
+    {
+        close_reader(&reader);
+        close_input(imageFile);
+        free_pnm(image);
+        return headerStatus;
+    } // end step 4
+
+    // step 5 - Store the pixels matrix, the ASCII one of a large file on several threads
+    if (is_binary((*image)->magicNumber) ? !store_raw_pixels(&reader, *image, &breakPointLine)
+                                         : !store_pixels_parallel(&reader, *image, threadsCount) && !store_pixels(&reader, image, &breakPointLine))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Error when storing the pixels around line %d in %s.\n", breakPointLine, filename);
+        free_pnm(image);
+        close_reader(&reader);
+        close_input(imageFile);
+        return -3;
+    } // end step 5
+
+    fprintf(get_messages_stream(), "> [Good news] Image successfully loaded.\n");
+    close_reader(&reader);
+    close_input(imageFile);
+    return 0;
+} // end load_pnm_parallel()
+
+/**
+ * \struct WRITER_t
+ * \brief  Buffered writer used to save the ASCII content of a pnm file.
+ */
+typedef struct WRITER_t
+{
+    int fd;             /*!< The file descriptor to write into. */
+    char *buffer;       /*!< The bytes formatted and not written yet. */
+    size_t size;        /*!< The number of bytes in buffer. */
+    size_t capacity;    /*!< The size of buffer. */
+    off_t offset;       /*!< The position in the file of the next write, -1 to write at the current position of fd. */
+} WRITER;
+
+/**
+ * \struct FORMAT_TASK_t
+ * \brief  The block of lines formatted and written by one thread of write_lines_parallel().
+ */
+typedef struct FORMAT_TASK_t
+{
+    PNM *image;             /*!< The image to write. */
+    WRITER writer;          /*!< The writer of the block, its offset is the position of the first line in the file. */
+    unsigned int firstLine; /*!< The first line of the block. */
+    unsigned int endLine;   /*!< The line following the last line of the block. */
+    size_t size;            /*!< The length of the block once formatted. */
+    int success;            /*!< Set once the block is written. */
+    int *stopped;           /*!< Shared by the blocks, set by the first one that fails to stop the others. */
+} FORMAT_TASK;
+
+/**
+ * \fn static int flush_writer(WRITER *writer)
+ * \brief Write the content of the buffer of a writer.
+ *
+ * \param writer The writer.
+ *
+ * \pre writer is instanced.
+ * \post The buffer is empty, it is left as it is in case of error.
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int flush_writer(WRITER *writer)
+{
+    size_t written = 0;
+    while (written < writer->size)
+    {
+        ssize_t result = writer->offset < 0 ? write(writer->fd, writer->buffer + written, writer->size - written)
+                                            : pwrite(writer->fd, writer->buffer + written, writer->size - written, writer->offset + (off_t)written);
+        // a write of nothing would be retried forever
+        if (result == 0 || (result < 0 && errno != EINTR))
+        {
+            return 0;
+        }
+        if (result > 0)
+        {
+            written += (size_t)result;
+        }
+    }
+    if (writer->offset >= 0)
+    {
+        writer->offset += (off_t)writer->size;
+    }
+    writer->size = 0;
+    return 1;
+} // end flush_writer()
+
+/**
+ * \fn static inline char *format_unsigned(char *out, unsigned int value)
+ * \brief Write the decimal representation of an unsigned integer (same as printf("%u")).
+ *
+ * \param out The address where to write the digits.
+ * \param value The integer.
+ *
+ * \pre out can hold 10 characters.
+ * \post The digits are written, without '\0'.
+ *
+ * \return char* The address following the last digit.
+ */
+static inline char *format_unsigned(char *out, unsigned int value)
+{
+    char digits[10];
+    char *first = digits + sizeof(digits);
+
+    while (value >= 100)
+    {
+        unsigned int pair = value % 100;
+        value /= 100;
+        first -= 2;
+        memcpy(first, DIGIT_PAIRS + 2 * pair, 2);
+    }
+    if (value >= 10)
+    {
+        first -= 2;
+        memcpy(first, DIGIT_PAIRS + 2 * value, 2);
+    }
+    else
+    {
+        *--first = (char)('0' + value);
+    }
+
+    size_t length = (size_t)(digits + sizeof(digits) - first);
+    memcpy(out, first, length);
+    return out + length;
+} // end format_unsigned()
+
+/**
+ * \fn static size_t max_line_text_len(PNM *image)
+ * \brief Get the maximum length of a line of the pixels matrix once written.
+ *
+ * \param image The image.
+ *
+ * \pre image is instanced.
+ * \post The length is returned.
+ *
+ * \return size_t The length, '\n' included for an ASCII image.
+ */
+static size_t max_line_text_len(PNM *image)
+{
+    if (is_binary(image->magicNumber))
+    {
+        return line_size(image->sampleWidth, samples_per_line(image));
+    }
+    size_t sampleLength = image->sampleWidth == BIT_SAMPLES ? 2 : MAX_SAMPLE_TEXT_LEN;
+    return (size_t)samples_per_line(image) * sampleLength + 1;
+} // end max_line_text_len()
+
+/**
+ * \fn static size_t format_line(PNM *image, unsigned int i, char *out)
+ * \brief Write a line of the pixels matrix as it appears in the file ("%hu " per sample and '\n', or the raw bytes of a binary image).
+ *
+ * \param image The image.
+ * \param i The index of the line.
+ * \param out The address where to write the line.
+ *
+ * \pre image is instanced, i < image->lines, out can hold max_line_text_len(image) characters.
+ * \post The line is written.
+ *
+ * \return size_t The number of characters written.
+ */
+static size_t format_line(PNM *image, unsigned int i, char *out)
+{
+    unsigned int linesLength = samples_per_line(image);
+    const unsigned char *line = pixels_line(image, i);
+    char *end = out;
+
+    if (is_binary(image->magicNumber))
+    {
+        if (image->sampleWidth != SHORT_SAMPLES)
+        {
+            size_t size = line_size(image->sampleWidth, linesLength);
+            memcpy(out, line, size);
+            return size;
+        }
+        for (unsigned int j = 0; j < linesLength; j++)
+        {
+            uint16_t sample = ((const uint16_t *)line)[j];
+            *end++ = (char)(sample >> 8);
+            *end++ = (char)(sample & 0xFF);
+        }
+        return (size_t)(end - out);
+    }
+
+    switch (image->sampleWidth)
+    {
+    case BIT_SAMPLES:
+        for (unsigned int j = 0; j < linesLength; j++)
+        {
+            *end++ = (char)('0' + read_sample(line, BIT_SAMPLES, j));
+            *end++ = ' ';
+        }
+        break;
+    case BYTE_SAMPLES:
+        for (unsigned int j = 0; j < linesLength; j++)
+        {
+            end = format_unsigned(end, line[j]);
+            *end++ = ' ';
+        }
+        break;
+    default:
+        for (unsigned int j = 0; j < linesLength; j++)
+        {
+            end = format_unsigned(end, ((const uint16_t *)line)[j]);
+            *end++ = ' ';
+        }
+        break;
+    }
+    *end++ = '\n';
+
+    return (size_t)(end - out);
+} // end format_line()
+
+/**
+ * \fn static char *format_header(PNM *image, char *out)
+ * \brief Write the header of an image as it appears in the file (magic number, number of columns and lines, max color value).
+ *
+ * \param image The image.
+ * \param out The address where to write the header.
+ *
+ * \pre image is instanced, out can hold MAX_HEADER_TEXT_LEN characters.
+ * \post The header is written, without '\0'.
+ *
+ * \return char* The address following the last character of the header.
+ */
+static char *format_header(PNM *image, char *out)
+{
+    *out++ = 'P';
+    *out++ = (char)('1' + image->magicNumber);
+    *out++ = '\n';
+    out = format_unsigned(out, image->columns);
+    *out++ = ' ';
+    out = format_unsigned(out, image->lines);
+    *out++ = '\n';
+    if (has_max_value(image->magicNumber))
+    {
+        out = format_unsigned(out, image->maxPossibleValue);
+        *out++ = '\n';
+    }
+    return out;
+} // end format_header()
+
+/**
+ * \fn static size_t line_text_len(PNM *image, unsigned int i)
+ * \brief Get the number of characters format_line() writes for a line, without formatting it.
+ *
+ * \param image The image.
+ * \param i The index of the line.
+ *
+ * \pre image is instanced, i < image->lines.
+ *
+ * \return size_t The length of the line in the file.
+ */
+static size_t line_text_len(PNM *image, unsigned int i)
+{
+    unsigned int linesLength = samples_per_line(image);
+    if (is_binary(image->magicNumber))
+    {
+        return line_size(image->sampleWidth, linesLength);
+    }
+    if (image->sampleWidth == BIT_SAMPLES)
+    {
+        return (size_t)linesLength * 2 + 1;
+    }
+
+    // a sample takes its digits and a space, the samples are 16 bits at most
+    const unsigned char *line = pixels_line(image, i);
+    size_t length = (size_t)linesLength * 2 + 1;
+    for (unsigned int j = 0; j < linesLength; j++)
+    {
+        unsigned int value = read_sample(line, image->sampleWidth, j);
+        length += (value >= 10) + (value >= 100) + (value >= 1000) + (value >= 10000);
+    }
+    return length;
+} // end line_text_len()
+
+/**
+ * \fn static int write_lines(PNM *image, WRITER *writer, unsigned int firstLine, unsigned int endLine, int *stopped)
+ * \brief Format lines of the pixels matrix in the buffer of a writer, flushed whenever the next line could overflow it.
+ *
+ * \param image The image.
+ * \param writer The writer, its buffer holds max_line_text_len(image) characters at least.
+ * \param firstLine The first line to write.
+ * \param endLine The line following the last line to write.
+ * \param stopped A flag set by another thread to give up at the next flush, NULL if none.
+ *
+ * \pre image is instanced, writer is instanced, firstLine <= endLine <= image->lines.
+ * \post The lines are written, the buffer is empty.
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int write_lines(PNM *image, WRITER *writer, unsigned int firstLine, unsigned int endLine, int *stopped)
+{
+    size_t lineLength = max_line_text_len(image);
+    int success = 1;
+    for (unsigned int i = firstLine; success && i < endLine; i++)
+    {
+        // a failed flush leaves the buffer full, nothing more is formatted in it
+        if (writer->capacity - writer->size < lineLength &&
+            !(success = flush_writer(writer) && !(stopped && __atomic_load_n(stopped, __ATOMIC_ACQUIRE))))
+        {
+            break;
+        }
+        writer->size += format_line(image, i, writer->buffer + writer->size);
+    }
+    return success && flush_writer(writer);
+} // end write_lines()
+
+/**
+ * \fn static void *text_length_worker(void *task)
+ * \brief Thread routine of write_lines_parallel() : get the length of a block once formatted.
+ *
+ * \param task The FORMAT_TASK to process.
+ *
+ * \pre task is instanced.
+ * \post task->size is set.
+ *
+ * \return void* NULL.
+ */
+static void *text_length_worker(void *task)
+{
+    FORMAT_TASK *block = task;
+    block->size = 0;
+    for (unsigned int i = block->firstLine; i < block->endLine; i++)
+    {
+        block->size += line_text_len(block->image, i);
+    }
+    return NULL;
+} // end text_length_worker()
+
+/**
+ * \fn static void *format_worker(void *task)
+ * \brief Thread routine of write_lines_parallel() : format a block in a buffer of its own, written at its offset.
+ *
+ * \param task The FORMAT_TASK to process.
+ *
+ * \pre task is instanced, its writer has a file descriptor, a capacity and an offset.
+ * \post The block is written, task->success is set, a failure sets task->stopped for the other blocks.
+ *
+ * \return void* NULL.
+ */
+static void *format_worker(void *task)
+{
+    FORMAT_TASK *block = task;
+    block->writer.size = 0;
+    block->writer.buffer = malloc(block->writer.capacity);
+    block->success = block->writer.buffer && write_lines(block->image, &block->writer, block->firstLine, block->endLine, block->stopped);
+    if (!block->success)
+    {
+        __atomic_store_n(block->stopped, 1, __ATOMIC_RELEASE);
+    }
+    free(block->writer.buffer);
+    block->writer.buffer = NULL;
+    return NULL;
+} // end format_worker()
+
+/**
+ * \fn static int write_lines_parallel(PNM *image, WRITER *writer, unsigned int threadsCount)
+ * \brief Write the pixels matrix of an image after its header, formatted on several threads.
+ *
+ * The lines are split in contiguous blocks, one per thread. The length of each block once formatted is computed
+ * first, their prefix sum gives the position of each block in the file, then each thread formats its block in a
+ * buffer of its own and writes it at its position. The file is the one write_lines() would write.
+ *
+ * \param image The image.
+ * \param writer The writer on a regular file, its buffer holds the header (it has not been flushed yet).
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, writer is instanced, threadsCount > 0.
+ * \post The header and the lines are written, the buffer is empty.
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int write_lines_parallel(PNM *image, WRITER *writer, unsigned int threadsCount)
+{
+    assert(image && writer && threadsCount > 0);
+    size_t textSize = max_line_text_len(image) * image->lines;
+    if (textSize / FORMAT_BLOCK_MIN_SIZE < threadsCount)
+    {
+        threadsCount = (unsigned int)(textSize / FORMAT_BLOCK_MIN_SIZE);
+    }
+    if (threadsCount > image->lines)
+    {
+        threadsCount = image->lines;
+    }
+
+    // Step 1 : the header is written first, the matrix follows it
+    off_t offset = (off_t)writer->size;
+    FORMAT_TASK *tasks = threadsCount > 1 ? calloc(threadsCount, sizeof(FORMAT_TASK)) : NULL;
+    pthread_t *threads = threadsCount > 1 ? malloc(threadsCount * sizeof(pthread_t)) : NULL;
+    int *started = threadsCount > 1 ? calloc(threadsCount, sizeof(int)) : NULL;
+    if (!tasks || !threads || !started)
+    {
+        // a single thread, or not enough memory for the blocks : the sequential path writes the same file
+        free(tasks);
+        free(threads);
+        free(started);
+        return write_lines(image, writer, 0, image->lines, NULL);
+    }
+    if (!flush_writer(writer))
+    {
+        free(tasks);
+        free(threads);
+        free(started);
+        return 0;
+    } // end Step 1
+
+    // Step 2 : the length of each block, their prefix sum places the blocks in the file
+    int stopped = 0;
+    for (unsigned int t = 0; t < threadsCount; t++)
+    {
+        tasks[t].image = image;
+        tasks[t].stopped = &stopped;
+        tasks[t].firstLine = (unsigned int)((uint64_t)image->lines * t / threadsCount);
+        tasks[t].endLine = (unsigned int)((uint64_t)image->lines * (t + 1) / threadsCount);
+    }
+    run_workers(text_length_worker, tasks, sizeof(FORMAT_TASK), threadsCount, threads, started);
+    for (unsigned int t = 0; t < threadsCount; t++)
+    {
+        tasks[t].writer.fd = writer->fd;
+        tasks[t].writer.capacity = writer->capacity;
+        tasks[t].writer.offset = offset;
+        offset += (off_t)tasks[t].size;
+    } // end Step 2
+
+    // Step 3 : format and write the blocks
+    run_workers(format_worker, tasks, sizeof(FORMAT_TASK), threadsCount, threads, started);
+    int success = 1;
+    for (unsigned int t = 0; t < threadsCount; t++)
+    {
+        success = success && tasks[t].success;
+    }
+    // end Step 3
+
+    free(tasks);
+    free(threads);
+    free(started);
+    return success;
+} // end write_lines_parallel()
+
+/**
+ * \fn static void store_little_endian(unsigned char *out, uint64_t value, unsigned int bytes)
+ * \brief Write the low bytes of a number, the least significant first.
+ *
+ * \param out The address where to write the bytes.
+ * \param value The number.
+ * \param bytes The number of bytes to write.
+ */
+static void store_little_endian(unsigned char *out, uint64_t value, unsigned int bytes)
+{
+    for (unsigned int b = 0; b < bytes; b++)
+    {
+        out[b] = (unsigned char)(value >> (8 * b));
+    }
+} // end store_little_endian()
+
+/**
+ * \fn static uint64_t load_little_endian(const unsigned char *in, unsigned int bytes)
+ * \brief Read a number written by store_little_endian().
+ *
+ * \param in The bytes.
+ * \param bytes The number of bytes to read.
+ *
+ * \return uint64_t The number.
+ */
+static uint64_t load_little_endian(const unsigned char *in, unsigned int bytes)
+{
+    uint64_t value = 0;
+    for (unsigned int b = bytes; b > 0; b--)
+    {
+        value = value << 8 | in[b - 1];
+    }
+    return value;
+} // end load_little_endian()
+
+/**
+ * \fn static char *index_name(char *imageName)
+ * \brief Get the name of the row index of an image.
+ *
+ * \param imageName The path of the image.
+ *
+ * \pre imageName is instanced.
+ *
+ * \return char* The name dynamically allocated.
+ *                NULL in case of error.
+ */
+static char *index_name(char *imageName)
+{
+    char *name = malloc(strlen(imageName) + strlen(INDEX_EXTENSION) + 1);
+    if (name)
+    {
+        strcpy(name, imageName);
+        strcat(name, INDEX_EXTENSION);
+    }
+    return name;
+} // end index_name()
+
+/**
+ * \fn static uint64_t line_check(const char *text, size_t length)
+ * \brief Get the check of the text of a line in a row index (FNV-1a hash), it ties the entry to the content of the image.
+ *
+ * \param text The text of the line, its line break included.
+ * \param length The length of the text.
+ *
+ * \return uint64_t The check.
+ */
+static uint64_t line_check(const char *text, size_t length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)text[i]) * 1099511628211ULL;
+    }
+    return hash;
+} // end line_check()
+
+/**
+ * \fn static void remove_index(char *imageName)
+ * \brief Remove the row index of an image, the image being written again without it.
+ *
+ * \param imageName The path of the image.
+ *
+ * \pre imageName is instanced.
+ * \post No row index is left next to the image.
+ */
+static void remove_index(char *imageName)
+{
+    char *name = index_name(imageName);
+    if (name)
+    {
+        unlink(name);
+    }
+    free(name);
+} // end remove_index()
+
+/**
+ * \fn static int write_index(PNM *image, char *filename, unsigned int step)
+ * \brief Write the row index of an ASCII image as write_pnm() writes it : the offset in the file of every step-th line
+ *        and the check of its text.
+ *
+ * The offsets are the lengths of the header and of the formatted lines before them, only the lines indexed are
+ * formatted again for their check.
+ *
+ * \param image The image.
+ * \param filename The path of the image.
+ * \param step The number of lines between two lines indexed.
+ *
+ * \pre image is instanced, filename is instanced, step > 0.
+ * \post The file filename.idx holds the index.
+ *
+ * \return int 0 Error of file manipulation
+ *             1 Success
+ */
+static int write_index(PNM *image, char *filename, unsigned int step)
+{
+    char *name = index_name(filename);
+    FILE *indexFile = name ? fopen(name, "wb") : NULL;
+    if (!indexFile)
+    {
+        free(name);
+        return 0;
+    }
+
+    // Step 1 : the entries, the size of the image in the header is known once they are all computed
+    unsigned char header[INDEX_HEADER_SIZE] = {0};
+    unsigned char entry[INDEX_ENTRY_SIZE];
+    char headerText[MAX_HEADER_TEXT_LEN];
+    char *text = malloc(max_line_text_len(image));
+    uint64_t offset = (uint64_t)(format_header(image, headerText) - headerText);
+    int success = text && fwrite(header, 1, INDEX_HEADER_SIZE, indexFile) == INDEX_HEADER_SIZE;
+    for (unsigned int i = 0; success && i < image->lines; i++)
+    {
+        if (i % step == 0)
+        {
+            store_little_endian(entry, offset, sizeof(uint64_t));
+            store_little_endian(entry + 8, line_check(text, format_line(image, i, text)), sizeof(uint64_t));
+            success = fwrite(entry, 1, INDEX_ENTRY_SIZE, indexFile) == INDEX_ENTRY_SIZE;
+        }
+        offset += line_text_len(image, i);
+    }
+    free(text);
+    // end Step 1
+
+    // Step 2 : the header, the size of the image tells a stale index
+    memcpy(header, INDEX_MAGIC, strlen(INDEX_MAGIC));
+    store_little_endian(header + 8, step, sizeof(uint32_t));
+    store_little_endian(header + 12, image->lines, sizeof(uint32_t));
+    store_little_endian(header + 16, offset, sizeof(uint64_t));
+    success = success && fseek(indexFile, 0, SEEK_SET) == 0 && fwrite(header, 1, INDEX_HEADER_SIZE, indexFile) == INDEX_HEADER_SIZE;
+    // end Step 2
+
+    success = fclose(indexFile) == 0 && success;
+    if (!success)
+    {
+        remove(name);
+    }
+    free(name);
+    return success;
+} // end write_index()
+
+int write_pnm(PNM *image, char *filename)
+{
+    return write_pnm_parallel(image, filename, 1);
+} // end write_pnm()
+
+int write_pnm_parallel(PNM *image, char *filename, unsigned int threadsCount)
+{
+    return write_pnm_indexed(image, filename, threadsCount, 0);
+} // end write_pnm_parallel()
+
+int write_pnm_indexed(PNM *image, char *filename, unsigned int threadsCount, unsigned int indexStep)
+{
+    assert(image && filename && threadsCount > 0);
+
+    int standardOutput = is_standard_stream(filename);
+    if (!standardOutput && !check_file_name(filename))
+    {
+        fprintf(get_messages_stream(), "> 🔴 The file name [%s] isn't allowed. Tips : the file have to be in the same directory as the executable, it can't contains these characters : %s \n", filename, forbidenCharactersInFiles);
+        return -1;
+    }
+
+    // Step 1 : open the file and the writer, a row index of the previous file is stale
+    if (!standardOutput)
+    {
+        remove_index(filename);
+    }
+    size_t lineLength = max_line_text_len(image);
+    WRITER writer;
+    writer.size = 0;
+    writer.offset = -1;
+    writer.capacity = lineLength > WRITER_BUFFER_SIZE ? lineLength : WRITER_BUFFER_SIZE;
+    if (!(writer.buffer = malloc(writer.capacity)))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to write the file.\n");
+        return -2;
+    }
+    writer.fd = standardOutput ? STDOUT_FILENO : open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (writer.fd < 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to open the file [%s]\n", filename);
+        free(writer.buffer);
+        return -2;
+    } // end Step 1
+
+    // Step 2 : header (magic number, number of columns and lines, max number for colors encoding)
+    writer.size = (size_t)(format_header(image, writer.buffer) - writer.buffer);
+    // end Step 2
+
+    // Step 3 : matrix lines, positioned in the file by their formatted lengths on several threads (the standard output can't seek)
+    int success = standardOutput ? write_lines(image, &writer, 0, image->lines, NULL) : write_lines_parallel(image, &writer, threadsCount);
+    // end Step 3
+
+    free(writer.buffer);
+    if (close_output(writer.fd) != 0 || !success)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to write the file [%s]\n", filename);
+        return -2;
+    }
+
+    // Step 4 : the row index of an ASCII image, the lines of a binary one are at fixed offsets
+    if (indexStep && !standardOutput && !is_binary(image->magicNumber) && !write_index(image, filename, indexStep))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to write the row index of the file [%s]\n", filename);
+        return -2;
+    } // end Step 4
+
+    fprintf(get_messages_stream(), "> [Good news] Image stored in [%s].\n", filename);
+    return 0;
+} // end write_pnm_indexed()
+
+unsigned int get_sample(PNM *image, unsigned int line, unsigned int sample)
+{
+    assert(image && image->pixels && line < image->lines && sample < samples_per_line(image));
+    return read_sample(pixels_line(image, line), image->sampleWidth, sample);
+} // end get_sample()
+
+/**
+ * \fn static void encrypt_raw_lines(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int firstLine, unsigned int endLine)
+ * \brief XOR in place a block of lines of a binary image with the keystream of a lfsr, keeping the width of the samples.
+ *
+ * \param image The image to encrypt (P4, P5 or P6).
+ * \param lfsr The lfsr, positioned at the first sample of firstLine.
+ * \param words The keystream of the whole image, NULL to generate it with lfsr.
+ * \param firstLine The first line to encrypt.
+ * \param endLine The line following the last line to encrypt.
+ *
+ * \pre image is instanced, lfsr or words is instanced, firstLine <= endLine <= image->lines.
+ * \post The lines are encrypted.
+ */
+static void encrypt_raw_lines(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int firstLine, unsigned int endLine)
+{
+    unsigned int columns = samples_per_line(image);
+    uint32_t block[KEYSTREAM_BLOCK];
+
+    for (unsigned int i = firstLine; i < endLine; i++)
+    {
+        unsigned char *line = pixels_line(image, i);
+
+        for (unsigned int j = 0; j < columns; j += KEYSTREAM_BLOCK)
+        {
+            unsigned int blockLength = columns - j < KEYSTREAM_BLOCK ? columns - j : KEYSTREAM_BLOCK;
+            const uint32_t *keystream = block;
+            if (words)
+            {
+                keystream = words + (size_t)i * columns + j;
+            }
+            else
+            {
+                lfsr_fill(lfsr, block, blockLength);
+            }
+
+            switch (image->sampleWidth)
+            {
+            case BIT_SAMPLES:
+                // KEYSTREAM_BLOCK is a multiple of 8, so a block begins on a byte
+                for (unsigned int k = 0; k < blockLength; k += 8)
+                {
+                    unsigned char mask = 0;
+                    for (unsigned int b = 0; b < 8 && k + b < blockLength; b++)
+                    {
+                        mask |= (unsigned char)((keystream[k + b] & 1) << (7 - b));
+                    }
+                    line[(j + k) / 8] ^= mask;
+                }
+                break;
+            case BYTE_SAMPLES:
+                for (unsigned int k = 0; k < blockLength; k++)
+                {
+                    line[j + k] ^= (unsigned char)keystream[k];
+                }
+                break;
+            default:
+                for (unsigned int k = 0; k < blockLength; k++)
+                {
+                    ((uint16_t *)line)[j + k] ^= (uint16_t)keystream[k];
+                }
+                break;
+            }
+        }
+    }
+} // end encrypt_raw_lines()
+
+/**
+ * \fn static unsigned short xor_max_scalar(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+ * \brief XOR 8 or 16 bits samples with keystream words, keep the 16 low bits and compute their max, one sample at a time.
+ *
+ * \param destination The address where to write the encrypted samples (may be source for 16 bits samples).
+ * \param source The samples.
+ * \param sourceWidth The width of the samples (BYTE_SAMPLES or SHORT_SAMPLES).
+ * \param keystream The keystream words.
+ * \param n The number of samples.
+ *
+ * \return unsigned short The max of the encrypted samples (0 if n == 0).
+ */
+static unsigned short xor_max_scalar(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+{
+    unsigned short maxValue = 0;
+    for (unsigned int k = 0; k < n; k++)
+    {
+        unsigned int sample = sourceWidth == BYTE_SAMPLES ? ((const uint8_t *)source)[k] : ((const uint16_t *)source)[k];
+        destination[k] = (uint16_t)(sample ^ keystream[k]);
+        if (destination[k] > maxValue)
+        {
+            maxValue = destination[k];
+        }
+    }
+    return maxValue;
+} // end xor_max_scalar()
+
+#ifdef XOR_MAX_SIMD
+/**
+ * \fn static inline __m128i low_halves_sse2(const uint32_t *keystream)
+ * \brief Get the 16 low bits of 8 keystream words.
+ *
+ * SSE2 has no truncating 32 to 16 bits pack : the low halves are sign extended so that the saturating pack keeps them unchanged.
+ */
+__attribute__((always_inline)) static inline __m128i low_halves_sse2(const uint32_t *keystream)
+{
+    __m128i low = _mm_loadu_si128((const __m128i *)keystream);
+    __m128i high = _mm_loadu_si128((const __m128i *)(keystream + 4));
+    low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+    high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+    return _mm_packs_epi32(low, high);
+} // end low_halves_sse2()
+
+/**
+ * \fn static unsigned short xor_max_sse2(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+ * \brief Same as xor_max_scalar(), 8 samples at a time with SSE2.
+ *
+ * SSE2 has no unsigned 16 bits max : it is computed on samples biased by 0x8000 with the signed max.
+ */
+static unsigned short xor_max_sse2(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+{
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    __m128i maxima = bias;
+    unsigned int k = 0;
+
+    if (sourceWidth == BYTE_SAMPLES)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; k + 8 <= n; k += 8)
+        {
+            __m128i samples = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)((const uint8_t *)source + k)), zero);
+            samples = _mm_xor_si128(samples, low_halves_sse2(keystream + k));
+            _mm_storeu_si128((__m128i *)(destination + k), samples);
+            maxima = _mm_max_epi16(maxima, _mm_xor_si128(samples, bias));
+        }
+    }
+    else
+    {
+        for (; k + 8 <= n; k += 8)
+        {
+            __m128i samples = _mm_loadu_si128((const __m128i *)((const uint16_t *)source + k));
+            samples = _mm_xor_si128(samples, low_halves_sse2(keystream + k));
+            _mm_storeu_si128((__m128i *)(destination + k), samples);
+            maxima = _mm_max_epi16(maxima, _mm_xor_si128(samples, bias));
+        }
+    }
+
+    // horizontal max, the lanes are swapped rather than shifted so that no biased 0 comes in
+    maxima = _mm_max_epi16(maxima, _mm_shuffle_epi32(maxima, _MM_SHUFFLE(1, 0, 3, 2)));
+    maxima = _mm_max_epi16(maxima, _mm_shuffle_epi32(maxima, _MM_SHUFFLE(2, 3, 0, 1)));
+    maxima = _mm_max_epi16(maxima, _mm_shufflelo_epi16(maxima, _MM_SHUFFLE(2, 3, 0, 1)));
+    unsigned short maxValue = (unsigned short)(_mm_cvtsi128_si32(maxima) ^ 0x8000);
+
+    const void *tail = sourceWidth == BYTE_SAMPLES ? (const void *)((const uint8_t *)source + k) : (const void *)((const uint16_t *)source + k);
+    unsigned short tailMax = xor_max_scalar(destination + k, tail, sourceWidth, keystream + k, n - k);
+    return tailMax > maxValue ? tailMax : maxValue;
+} // end xor_max_sse2()
+
+/**
+ * \fn static inline __m256i low_halves_avx2(const uint32_t *keystream)
+ * \brief Get the 16 low bits of 16 keystream words.
+ *
+ * The pack works inside each 128 bits lane, the 64 bits quarters are put back in order afterwards.
+ */
+__attribute__((target("avx2"), always_inline)) static inline __m256i low_halves_avx2(const uint32_t *keystream)
+{
+    __m256i low = _mm256_loadu_si256((const __m256i *)keystream);
+    __m256i high = _mm256_loadu_si256((const __m256i *)(keystream + 8));
+    low = _mm256_srai_epi32(_mm256_slli_epi32(low, 16), 16);
+    high = _mm256_srai_epi32(_mm256_slli_epi32(high, 16), 16);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+} // end low_halves_avx2()
+
+/**
+ * \fn static unsigned short xor_max_avx2(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+ * \brief Same as xor_max_scalar(), 16 samples at a time with AVX2.
+ */
+__attribute__((target("avx2"))) static unsigned short xor_max_avx2(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+{
+    __m256i maxima = _mm256_setzero_si256();
+    unsigned int k = 0;
+
+    if (sourceWidth == BYTE_SAMPLES)
+    {
+        for (; k + 16 <= n; k += 16)
+        {
+            __m256i samples = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)((const uint8_t *)source + k)));
+            samples = _mm256_xor_si256(samples, low_halves_avx2(keystream + k));
+            _mm256_storeu_si256((__m256i *)(destination + k), samples);
+            maxima = _mm256_max_epu16(maxima, samples);
+        }
+    }
+    else
+    {
+        for (; k + 16 <= n; k += 16)
+        {
+            __m256i samples = _mm256_loadu_si256((const __m256i *)((const uint16_t *)source + k));
+            samples = _mm256_xor_si256(samples, low_halves_avx2(keystream + k));
+            _mm256_storeu_si256((__m256i *)(destination + k), samples);
+            maxima = _mm256_max_epu16(maxima, samples);
+        }
+    }
+
+    __m128i half = _mm_max_epu16(_mm256_castsi256_si128(maxima), _mm256_extracti128_si256(maxima, 1));
+    half = _mm_max_epu16(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_max_epu16(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    half = _mm_max_epu16(half, _mm_shufflelo_epi16(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    unsigned short maxValue = (unsigned short)_mm_cvtsi128_si32(half);
+    // the tail is done by SSE2 code, which would pay for a dirty upper state
+    _mm256_zeroupper();
+
+    const void *tail = sourceWidth == BYTE_SAMPLES ? (const void *)((const uint8_t *)source + k) : (const void *)((const uint16_t *)source + k);
+    unsigned short tailMax = xor_max_sse2(destination + k, tail, sourceWidth, keystream + k, n - k);
+    return tailMax > maxValue ? tailMax : maxValue;
+} // end xor_max_avx2()
+#endif // XOR_MAX_SIMD
+
+/**
+ * \fn static unsigned short xor_max(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+ * \brief XOR 8 or 16 bits samples with keystream words, keep the 16 low bits and compute their max.
+ *
+ * Uses the widest kernel the processor supports, all of them give the same result as xor_max_scalar().
+ *
+ * \param destination The address where to write the encrypted samples (may be source for 16 bits samples).
+ * \param source The samples.
+ * \param sourceWidth The width of the samples (BYTE_SAMPLES or SHORT_SAMPLES).
+ * \param keystream The keystream words.
+ * \param n The number of samples.
+ *
+ * \return unsigned short The max of the encrypted samples (0 if n == 0).
+ */
+static unsigned short xor_max(uint16_t *destination, const void *source, SAMPLE_WIDTH sourceWidth, const uint32_t *keystream, unsigned int n)
+{
+#ifdef XOR_MAX_SIMD
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return xor_max_avx2(destination, source, sourceWidth, keystream, n);
+    }
+    return xor_max_sse2(destination, source, sourceWidth, keystream, n);
+#else
+    return xor_max_scalar(destination, source, sourceWidth, keystream, n);
+#endif
+} // end xor_max()
+
+/**
+ * \fn static unsigned short encrypt_lines(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int firstLine, unsigned int endLine, unsigned char *encrypted, size_t encryptedStride)
+ * \brief XOR a block of lines with the keystream of a lfsr.
+ *
+ * Only the 16 low bits of an encrypted sample are kept, so the result is always stored in 16 bits, in place
+ * when the matrix is already made of 16 bits samples. A binary image is handed to encrypt_raw_lines().
+ *
+ * \param image The image to encrypt.
+ * \param lfsr The lfsr, positioned at the first sample of firstLine.
+ * \param words The keystream of the whole image, NULL to generate it with lfsr.
+ * \param firstLine The first line to encrypt.
+ * \param endLine The line following the last line to encrypt.
+ * \param encrypted The 16 bits matrix receiving the encrypted samples (may be image->pixels).
+ * \param encryptedStride The stride of encrypted.
+ *
+ * \pre image is instanced, lfsr or words is instanced, firstLine <= endLine <= image->lines.
+ * \post The lines are encrypted in encrypted.
+ *
+ * \return unsigned short The max (16 bits) value of the encrypted lines.
+ */
+static unsigned short encrypt_lines(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int firstLine, unsigned int endLine, unsigned char *encrypted, size_t encryptedStride)
+{
+    if (is_binary(image->magicNumber))
+    {
+        encrypt_raw_lines(image, lfsr, words, firstLine, endLine);
+        return 0;
+    }
+
+    unsigned int columns = samples_per_line(image);
+    unsigned short maxValue = 0;
+    uint32_t block[KEYSTREAM_BLOCK];
+
+    for (unsigned int i = firstLine; i < endLine; i++)
+    {
+        const unsigned char *source = pixels_line(image, i);
+        uint16_t *destination = (uint16_t *)(encrypted + (size_t)i * encryptedStride);
+
+        for (unsigned int j = 0; j < columns; j += KEYSTREAM_BLOCK)
+        {
+            unsigned int blockLength = columns - j < KEYSTREAM_BLOCK ? columns - j : KEYSTREAM_BLOCK;
+            const uint32_t *keystream = block;
+            if (words)
+            {
+                keystream = words + (size_t)i * columns + j;
+            }
+            else
+            {
+                lfsr_fill(lfsr, block, blockLength);
+            }
+
+            switch (image->sampleWidth)
+            {
+            case BIT_SAMPLES:
+                for (unsigned int k = 0; k < blockLength; k++)
+                {
+                    destination[j + k] = (uint16_t)(read_sample(source, BIT_SAMPLES, j + k) ^ keystream[k]);
+                    if (destination[j + k] > maxValue)
+                    {
+                        maxValue = destination[j + k];
+                    }
+                }
+                break;
+            default:
+            {
+                unsigned short blockMax = xor_max(destination + j, source + j * (image->sampleWidth / 8), image->sampleWidth, keystream, blockLength);
+                if (blockMax > maxValue)
+                {
+                    maxValue = blockMax;
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    return maxValue;
+} // end encrypt_lines()
+
+/**
+ * \fn static unsigned char *create_encrypted_matrix(PNM *image, size_t *stride)
+ * \brief Get the 16 bits matrix that will receive the encrypted samples.
+ *
+ * \param image The image to encrypt.
+ * \param stride The address where to write the stride of the matrix.
+ *
+ * \pre image is instanced, stride is instanced.
+ * \post The matrix is returned.
+ *
+ * \return unsigned char* image->pixels if it is already made of 16 bits samples or is binary, a new matrix otherwise.
+ *                        NULL in case of error.
+ */
+static unsigned char *create_encrypted_matrix(PNM *image, size_t *stride)
+{
+    if (image->sampleWidth == SHORT_SAMPLES || is_binary(image->magicNumber))
+    {
+        *stride = image->stride;
+        return image->pixels;
+    }
+    return create_matrix(image->lines, line_size(SHORT_SAMPLES, samples_per_line(image)), stride);
+} // end create_encrypted_matrix()
+
+/**
+ * \fn static void store_encrypted_matrix(PNM *image, unsigned char *encrypted, size_t stride, unsigned short maxValue)
+ * \brief Replace the pixels matrix of an image by its encrypted version.
+ *
+ * \param image The image.
+ * \param encrypted The matrix returned by create_encrypted_matrix(), filled in.
+ * \param stride The stride of encrypted.
+ * \param maxValue The max (16 bits) value of the encrypted samples.
+ *
+ * \pre image is instanced, encrypted is instanced.
+ * \post The image holds the encrypted samples, and the new max color value for P2 / P3.
+ */
+static void store_encrypted_matrix(PNM *image, unsigned char *encrypted, size_t stride, unsigned short maxValue)
+{
+    if (encrypted != image->pixels)
+    {
+        free_matrix(image->pixels);
+        image->pixels = encrypted;
+        image->stride = stride;
+        image->sampleWidth = SHORT_SAMPLES;
+    }
+    if (image->magicNumber == P2 || image->magicNumber == P3)
+    {
+        image->maxPossibleValue = (unsigned int)maxValue;
+    }
+} // end store_encrypted_matrix()
+
+/**
+ * \fn static void *encryption_worker(void *task)
+ * \brief Thread routine of encrypt_image().
+ *
+ * \param task The ENCRYPTION_TASK to process.
+ *
+ * \pre task is instanced.
+ * \post The block is encrypted and task->maxValue is set.
+ *
+ * \return void* NULL.
+ */
+static void *encryption_worker(void *task)
+{
+    ENCRYPTION_TASK *block = task;
+    block->maxValue = encrypt_lines(block->image, block->lfsr, block->keystream, block->firstLine, block->endLine, block->encrypted, block->encryptedStride);
+    return NULL;
+} // end encryption_worker()
+
+int pnm_file_encryption(PNM *image, LFSR *lfsr)
+{
+    assert(image && lfsr);
+
+    size_t stride;
+    unsigned char *encrypted = create_encrypted_matrix(image, &stride);
+    if (!encrypted)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate the required memory space to encrypt the image.\n");
+        return -1;
+    }
+
+    unsigned short maxValue = encrypt_lines(image, lfsr, NULL, 0, image->lines, encrypted, stride);
+    store_encrypted_matrix(image, encrypted, stride, maxValue);
+    return 0;
+} // end pnm_file_encryption()
+
+/**
+ * \fn static int encrypt_image(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int threadsCount)
+ * \brief Encrypt an image on several threads, with the keystream of a lfsr or a precomputed one.
+ *
+ * \param image The image to encrypt.
+ * \param lfsr The lfsr, positioned at the beginning of the keystream (NULL when words is given).
+ * \param words The keystream of the whole image, NULL to generate it with lfsr.
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, lfsr or words is instanced, threadsCount > 0.
+ * \post The image pixels matrix is encrypted, lfsr is in the state pnm_file_encryption() would leave it.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation (the image is left unchanged)
+ */
+static int encrypt_image(PNM *image, LFSR *lfsr, const uint32_t *words, unsigned int threadsCount)
+{
+    if (threadsCount > image->lines)
+    {
+        threadsCount = image->lines;
+    }
+
+    // Step 1 : split the lines and position a lfsr copy at the beginning of each block
+    size_t stride;
+    unsigned char *encrypted = create_encrypted_matrix(image, &stride);
+    if (!encrypted)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate the required memory space to encrypt the image.\n");
+        return -1;
+    }
+    uint64_t bitsPerLine = (uint64_t)samples_per_line(image) * 32;
+    ENCRYPTION_TASK *tasks = threadsCount > 1 ? calloc(threadsCount, sizeof(ENCRYPTION_TASK)) : NULL;
+    pthread_t *threads = threadsCount > 1 ? malloc(threadsCount * sizeof(pthread_t)) : NULL;
+    int ready = tasks && threads;
+    for (unsigned int t = 0; ready && t < threadsCount; t++)
+    {
+        tasks[t].image = image;
+        tasks[t].encrypted = encrypted;
+        tasks[t].encryptedStride = stride;
+        tasks[t].keystream = words;
+        tasks[t].firstLine = (unsigned int)((uint64_t)image->lines * t / threadsCount);
+        tasks[t].endLine = (unsigned int)((uint64_t)image->lines * (t + 1) / threadsCount);
+        if (!words && (!(tasks[t].lfsr = copy_lfsr(lfsr)) || lfsr_jump(tasks[t].lfsr, bitsPerLine * tasks[t].firstLine) != 0))
+        {
+            ready = 0;
+        }
+    }
+    // the caller's lfsr ends where the sequential path would leave it
+    if (ready && !words && lfsr_jump(lfsr, bitsPerLine * image->lines) != 0)
+    {
+        ready = 0;
+    }
+    if (!ready)
+    {
+        // a single thread, or not enough memory for the copies : the sequential path gives the same result
+        for (unsigned int t = 0; tasks && t < threadsCount; t++)
+        {
+            if (tasks[t].lfsr)
+            {
+                free_lfsr(&tasks[t].lfsr);
+            }
+        }
+        free(tasks);
+        free(threads);
+        store_encrypted_matrix(image, encrypted, stride, encrypt_lines(image, lfsr, words, 0, image->lines, encrypted, stride));
+        return 0;
+    } // end Step 1
+
+    // Step 2 : encrypt the blocks, a block whose thread can't be started is done by the caller
+    int *started = calloc(threadsCount, sizeof(int));
+    for (unsigned int t = 0; t < threadsCount; t++)
+    {
+        if (started && pthread_create(&threads[t], NULL, encryption_worker, &tasks[t]) == 0)
+        {
+            started[t] = 1;
+        }
+        else
+        {
+            encryption_worker(&tasks[t]);
+        }
+    } // end Step 2
+
+    // Step 3 : join the threads and combine their max values
+    unsigned short maxValue = 0;
+    for (unsigned int t = 0; t < threadsCount; t++)
+    {
+        if (started && started[t])
+        {
+            pthread_join(threads[t], NULL);
+        }
+        if (tasks[t].maxValue > maxValue)
+        {
+            maxValue = tasks[t].maxValue;
+        }
+        if (tasks[t].lfsr)
+        {
+            free_lfsr(&tasks[t].lfsr);
+        }
+    }
+    free(started);
+    free(tasks);
+    free(threads);
+    // end Step 3
+
+    store_encrypted_matrix(image, encrypted, stride, maxValue);
+    return 0;
+} // end encrypt_image()
+
+int pnm_file_encryption_parallel(PNM *image, LFSR *lfsr, unsigned int threadsCount)
+{
+    assert(image && lfsr && threadsCount > 0);
+    return encrypt_image(image, lfsr, NULL, threadsCount);
+} // end pnm_file_encryption_parallel()
+
+int pnm_file_encryption_keystream(PNM *image, const uint32_t *keystream, unsigned int threadsCount)
+{
+    assert(image && keystream && threadsCount > 0);
+    return encrypt_image(image, NULL, keystream, threadsCount);
+} // end pnm_file_encryption_keystream()
+
+size_t get_samples_count(PNM *image)
+{
+    assert(image);
+    return (size_t)image->lines * samples_per_line(image);
+} // end get_samples_count()
+
+/**
+ * \fn static void ring_push(RING *ring, PNM *band)
+ * \brief Queue a band, waiting while the ring is full (the producer is held back by a slower consumer).
+ *
+ * \param ring The ring, this thread is its only producer.
+ * \param band The band.
+ *
+ * \pre ring is instanced, band is instanced.
+ * \post The band is visible to the consumer.
+ */
+static void ring_push(RING *ring, PNM *band)
+{
+    size_t tail = ring->tail;
+    while (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == ring->capacity)
+    {
+        sched_yield();
+    }
+    ring->slots[tail % ring->capacity] = band;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+} // end ring_push()
+
+/**
+ * \fn static PNM *ring_pop(RING *ring)
+ * \brief Take the oldest band of a ring, waiting while it is empty.
+ *
+ * \param ring The ring, this thread is its only consumer.
+ *
+ * \pre ring is instanced.
+ * \post The band is removed from the ring.
+ *
+ * \return PNM* The band.
+ */
+static PNM *ring_pop(RING *ring)
+{
+    size_t head = ring->head;
+    while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+    {
+        sched_yield();
+    }
+    PNM *band = ring->slots[head % ring->capacity];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return band;
+} // end ring_pop()
 
 /**
- * \struct PNM_t
- * \brief  Data structure representing a pnm image
+ * \struct PIPELINE_t
+ * \brief  The stages of a streamed encryption : a reader thread, an encryption thread and the writer (the caller).
+ *
+ * The bands go around three rings : free -> read -> encrypted -> free. A band of 0 lines closes the image.
  */
-struct PNM_t
+typedef struct PIPELINE_t
 {
-    MAGIC_NUMBERS magicNumber;     /*!< The magic number of the file (P1, P2, P3). */
-    unsigned int columns;          /*!< The quantity of columns / the length of a line. */
-    unsigned int lines;            /*!< The quantity of lines / the length of the pixels matrix. */
-    unsigned int maxPossibleValue; /*!< The maximum encoding value (in case of P2 / P3 file). */
-    unsigned int **pixels;         /*!< The matrix of pixels */
-};
+    READER *reader;               /*!< The reader on the input, used by the reader thread only. */
+    char *input;                  /*!< The path of the input (for the error messages). */
+    unsigned int lines;           /*!< The number of lines of the image. */
+    unsigned int bandLines;       /*!< The number of lines of a band. */
+    unsigned int *breakPointLine; /*!< The current line in the input file. */
+    LFSR *lfsr;                   /*!< The lfsr, used by the encryption thread only. */
+    RING free;                    /*!< The bands given back by the writer to the reader. */
+    RING read;                    /*!< The bands read, waiting for the encryption. */
+    RING encrypted;               /*!< The bands encrypted, waiting for the writer. */
+    int status;                   /*!< -3 when the reader found a malformed content, 0 otherwise. */
+    int stopped;                  /*!< Set by the writer after a write error, the reader stops early. */
+    unsigned short maxValue;      /*!< The max (16 bits) value of the encrypted samples. */
+} PIPELINE;
 
 /**
- * \fn static int go_to_next_data(FILE* fp, unsigned int* breakPointLine)
- * \brief Go to the first visible character (i.e. not [' ', '\n', '\r', '', '\t',...] ) wich isn't in a commented area.
+ * \fn static void *pipeline_reader(void *pipeline)
+ * \brief Thread routine of the reader stage, fills the free bands with the lines of the input.
  *
- * \param fp file to iterate into.
- * \param breakPointLine The current line in the file.
+ * \param pipeline The PIPELINE.
  *
- * \pre fp is instanced, breakPointLine is instanced.
- * \post The playhead points to the next uncommented area.
+ * \pre pipeline is instanced, the header of the input is read.
+ * \post Every line is queued (or the content is malformed), followed by a band of 0 lines.
  *
- * \return int 0 error
- *             1 success
+ * \return void* NULL.
  */
-static int go_to_next_data(FILE *fp, unsigned int *breakPointLine)
+static void *pipeline_reader(void *pipeline)
 {
-    assert(fp && breakPointLine);
-    char buffer;
-    int valueFound = 0;
-
-    while (!valueFound)
+    PIPELINE *stages = pipeline;
+    unsigned int line = 0;
+    PNM *band = ring_pop(&stages->free);
+    while (line < stages->lines && !__atomic_load_n(&stages->stopped, __ATOMIC_ACQUIRE))
     {
-        if ((buffer = getc(fp)) < 0)
-        {
-            return 0;
-        }
-        if (buffer == '\n' || buffer == '\r')
-        {
-            (*breakPointLine)++;
-        }
-        if (isgraph(buffer))
+        band->lines = stages->lines - line < stages->bandLines ? stages->lines - line : stages->bandLines;
+        for (unsigned int i = 0; i < band->lines; i++)
         {
-            valueFound = 1;
+            if (is_binary(band->magicNumber) ? !store_raw_line(stages->reader, band, i, line + i) : !store_line(stages->reader, band, i, line + i, stages->breakPointLine))
+            {
+                fprintf(get_messages_stream(), "> 🔴 Error when storing the pixels around line %d in %s.\n", *stages->breakPointLine, stages->input);
+                stages->status = -3;
+                band->lines = 0;
+                ring_push(&stages->read, band);
+                return NULL;
+            }
         }
+        line += band->lines;
+        ring_push(&stages->read, band);
+        band = ring_pop(&stages->free);
     }
+    band->lines = 0;
+    ring_push(&stages->read, band);
+    return NULL;
+} // end pipeline_reader()
 
-    if (buffer == '#')
+/**
+ * \fn static void *pipeline_encryption(void *pipeline)
+ * \brief Thread routine of the encryption stage, encrypts the bands read in place.
+ *
+ * \param pipeline The PIPELINE.
+ *
+ * \pre pipeline is instanced.
+ * \post Every band is encrypted and queued for the writer, up to the band of 0 lines.
+ *
+ * \return void* NULL.
+ */
+static void *pipeline_encryption(void *pipeline)
+{
+    PIPELINE *stages = pipeline;
+    while (1)
     {
-        int newLineFound = 0;
-        while (!newLineFound)
+        PNM *band = ring_pop(&stages->read);
+        if (band->lines)
         {
-            if ((buffer = getc(fp)) < 0)
+            unsigned short bandMax = encrypt_lines(band, stages->lfsr, NULL, 0, band->lines, band->pixels, band->stride);
+            if (bandMax > stages->maxValue)
             {
-                return 0;
-            }
-            if (buffer == '\n' || buffer == '\r')
-            {
-                (*breakPointLine)++;
-                newLineFound = 1;
+                stages->maxValue = bandMax;
             }
         }
-        if (!go_to_next_data(fp, breakPointLine))
+        ring_push(&stages->encrypted, band);
+        if (!band->lines)
         {
-            return 0;
+            return NULL;
         }
     }
-    else
-    {
-        ungetc(buffer, fp);
-    }
-
-    return 1;
-} // end go_to_next_data()
+} // end pipeline_encryption()
 
 /**
- * \fn static int store_pixels(FILE* imageFile, PNM** image, unsigned int* breakPointLine)
- * \brief Store the pixels matrix found in a file in a PNM structure.
+ * \fn static int run_pipeline(PIPELINE *pipeline, PNM *header, WRITER *writer, size_t lineLength, unsigned int depth)
+ * \brief Read, encrypt and write the lines of a streamed image on three threads, the caller being the writer.
  *
- * \param imageFile The file.
- * \param image The image struct.
- * \param breakPointLine The current line in the file.
+ * Each ring holds up to depth bands and 2 * depth + 3 bands go around, so a full ring holds back the stage
+ * feeding it and the memory used stays bounded.
  *
- * \pre fp is instanced, image is instanced.
- * \post The matrix is store.
+ * \param pipeline The pipeline, its reader, input, lines, breakPointLine and lfsr are set.
+ * \param header A one line image with the header of the input, its sample width set.
+ * \param writer The writer on the output.
+ * \param lineLength The maximum length of a formatted line.
+ * \param depth The capacity of the rings.
  *
- * \return int 0 Error
- *             1 Success
+ * \pre All the pointers are instanced, depth > 0.
+ * \post The lines are written, pipeline->status and pipeline->maxValue are set.
+ *
+ * \return int 0 Error of memory allocation or of file manipulation
+ *              1 Success (pipeline->status tells if the content was complete)
  */
-static int store_pixels(FILE *imageFile, PNM **image, unsigned int *breakPointLine)
+static int run_pipeline(PIPELINE *pipeline, PNM *header, WRITER *writer, size_t lineLength, unsigned int depth)
 {
-    assert(imageFile && image);
-
-    // Step 1 : creation of the pixels matrix
-    unsigned int linesLength = (*image)->columns;
-    if ((*image)->magicNumber == P3)
+    // Step 1 : the bands and the rings
+    size_t lineBytes = line_size(header->sampleWidth, samples_per_line(header));
+    unsigned int bandsCount = 2 * depth + 3;
+    pipeline->bandLines = lineBytes >= PIPELINE_BAND_SIZE ? 1 : (unsigned int)(PIPELINE_BAND_SIZE / lineBytes);
+    if (pipeline->bandLines > pipeline->lines)
     {
-        linesLength *= 3;
+        pipeline->bandLines = pipeline->lines ? pipeline->lines : 1;
     }
-    if (!((*image)->pixels = create_matrix((*image)->lines, linesLength)))
+    pipeline->status = 0;
+    pipeline->stopped = 0;
+    pipeline->maxValue = 0;
+    memset(&pipeline->free, 0, sizeof(RING));
+    memset(&pipeline->read, 0, sizeof(RING));
+    memset(&pipeline->encrypted, 0, sizeof(RING));
+    pipeline->free.capacity = bandsCount;
+    pipeline->read.capacity = pipeline->encrypted.capacity = depth;
+    pipeline->free.slots = malloc(bandsCount * sizeof(PNM *));
+    pipeline->read.slots = malloc(depth * sizeof(PNM *));
+    pipeline->encrypted.slots = malloc(depth * sizeof(PNM *));
+    PNM *bands = calloc(bandsCount, sizeof(PNM));
+    int success = pipeline->free.slots && pipeline->read.slots && pipeline->encrypted.slots && bands;
+    for (unsigned int b = 0; success && b < bandsCount; b++)
     {
-        printf("> 🔴 Unable to allocate the required memory space to store the image.\n");
-        return -1;
+        bands[b] = *header;
+        if (!(bands[b].pixels = create_matrix(pipeline->bandLines, lineBytes, &bands[b].stride)))
+        {
+            success = 0;
+            break;
+        }
+        ring_push(&pipeline->free, &bands[b]);
     } // end Step 1
 
-    // Step 2 : fill in the pixels matrix
-    for (unsigned int i = 0; i < (*image)->lines; i++)
+    // Step 2 : the reader and the encryption threads, the encryption can't start without the reader
+    pthread_t readerThread;
+    pthread_t encryptionThread;
+    if (success && pthread_create(&encryptionThread, NULL, pipeline_encryption, pipeline) != 0)
     {
-        for (unsigned int j = 0; j < linesLength; j++)
+        success = 0;
+    }
+    else if (success && pthread_create(&readerThread, NULL, pipeline_reader, pipeline) != 0)
+    {
+        PNM *band = ring_pop(&pipeline->free);
+        band->lines = 0;
+        ring_push(&pipeline->read, band);
+        pthread_join(encryptionThread, NULL);
+        success = 0;
+    }
+    if (!success)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to encrypt the file.\n");
+    } // end Step 2
+
+    // Step 3 : write the bands as they come, a failed write stops the reader and the bands are drained
+    for (PNM *band = success ? ring_pop(&pipeline->encrypted) : NULL; band; band = ring_pop(&pipeline->encrypted))
+    {
+        for (unsigned int i = 0; i < band->lines && success; i++)
         {
-            if (!go_to_next_data(imageFile, breakPointLine))
+            if (writer->capacity - writer->size < lineLength && !flush_writer(writer))
             {
-                printf("> 🔴 No more pixels to read. Position reached in the matrix : [%d, %d].\n", i + 1, j + 1);
-                return 0;
-            }
-            if (fscanf(imageFile, "%u", &(*image)->pixels[i][j]) != 1)
-            {
-                printf("> 🔴 No number to read. Position reached in the matrix : [%d, %d].\n", i + 1, j + 1);
-                return 0;
+                success = 0;
+                __atomic_store_n(&pipeline->stopped, 1, __ATOMIC_RELEASE);
             }
+            writer->size += success ? format_line(band, i, writer->buffer + writer->size) : 0;
         }
-    } // end Step 2
+        if (!band->lines)
+        {
+            pthread_join(readerThread, NULL);
+            pthread_join(encryptionThread, NULL);
+            break;
+        }
+        ring_push(&pipeline->free, band);
+    } // end Step 3
 
-    return 1;
-} // end store_pixels()
+    for (unsigned int b = 0; bands && b < bandsCount && bands[b].pixels; b++)
+    {
+        free_matrix(bands[b].pixels);
+    }
+    free(bands);
+    free(pipeline->free.slots);
+    free(pipeline->read.slots);
+    free(pipeline->encrypted.slots);
+    return success;
+} // end run_pipeline()
 
-int load_pnm(PNM **image, char *filename)
+int pnm_file_encryption_stream(char *input, char *output, LFSR *lfsr, unsigned int depth)
 {
-    assert(image != NULL && filename != NULL);
+    assert(input && output && lfsr);
 
-    // step 1 - checking for the file name extension and compare it with the magic number
-    char *extension;
-    if (!(extension = get_file_extension(filename)))
+    // Step 1 : check the file names, "-" is a standard stream (the format of the input is then its magic number)
+    char *extension = NULL;
+    int standardInput = is_standard_stream(input);
+    int standardOutput = is_standard_stream(output);
+    if (!standardInput && !(extension = get_file_extension(input)))
     {
-        printf("> 🔴 Unable to get the file extension: [%s]\n", filename);
+        fprintf(get_messages_stream(), "> 🔴 Unable to get the file extension: [%s]\n", input);
         return -2;
-    } // end step 1
+    }
+    if (!standardOutput && !check_file_name(output))
+    {
+        fprintf(get_messages_stream(), "> 🔴 The file name [%s] isn't allowed. Tips : the file have to be in the same directory as the executable, it can't contains these characters : %s \n", output, forbidenCharactersInFiles);
+        return -2;
+    } // end Step 1
 
-    // step 2 - Open the file
-    FILE *imageFile = NULL;
-    imageFile = fopen(filename, "r");
+    // Step 2 : open the input and read its header
+    FILE *imageFile = standardInput ? stdin : fopen(input, "r");
     if (!imageFile)
     {
-        printf("> 🔴 Unable to open the file [%s].\n", filename);
+        fprintf(get_messages_stream(), "> 🔴 Unable to open the file [%s].\n", input);
         return -1;
-    } // end step 2
-
-    // step 3 - create the pnm instance
-    *image = malloc(sizeof(PNM));
-    if (!(*image))
+    }
+    READER reader;
+    if (!open_reader(&reader, imageFile))
     {
-        printf("> 🔴 Unable to allocate memory space for the image.\n");
-        fclose(imageFile);
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to read the file.\n");
+        close_input(imageFile);
         return -1;
     }
-    (*image)->pixels = NULL;
-    // end step 3
-
-    // step 4 : store magic number
     unsigned int breakPointLine = 1;
-    char magicNumberString[MAGIC_NUMBER_LEN];
+    PNM row;
+    int status = read_header(&reader, &row, extension, &breakPointLine);
+    if (status == 0 && is_binary(row.magicNumber) && !read_raw_separator(&reader, &row, &breakPointLine))
+    {
+        status = -3;
+    }
+    if (status != 0)
+    {
+        close_reader(&reader);
+        close_input(imageFile);
+        return status;
+    } // end Step 2
 
-    if (!go_to_next_data(imageFile, &breakPointLine))
+    // Step 3 : a one line image holds the line being processed, an ASCII line is stored in 16 bits as it is once encrypted
+    row.sampleWidth = is_binary(row.magicNumber) ? header_sample_width(&row) : SHORT_SAMPLES;
+    row.pixels = create_matrix(1, line_size(row.sampleWidth, samples_per_line(&row)), &row.stride);
+    size_t lineLength = max_line_text_len(&row);
+    WRITER writer;
+    writer.size = 0;
+    writer.offset = -1;
+    writer.capacity = lineLength > WRITER_BUFFER_SIZE ? lineLength : WRITER_BUFFER_SIZE;
+    writer.buffer = malloc(writer.capacity);
+    if (!row.pixels || !writer.buffer)
     {
-        printf("> 🔴 Unable to continue file read after magic number.\n");
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to encrypt the file.\n");
+        free_matrix(row.pixels);
+        free(writer.buffer);
+        close_reader(&reader);
+        close_input(imageFile);
+        return -1;
     }
-    if (breakPointLine > 1)
+    // a row index of the previous file is stale, a streamed image is written without one
+    if (!standardOutput)
     {
-        printf("> 🔴 The file have to begin with the magic number at line 1\n");
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
+        remove_index(output);
     }
-    if (fscanf(imageFile, "%2[^#]", magicNumberString) != 1)
+    writer.fd = standardOutput ? STDOUT_FILENO : open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (writer.fd < 0)
     {
-        printf("> 🔴 Unable to find a string at line 1.\n");
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
-    } // end step 4
+        fprintf(get_messages_stream(), "> 🔴 Unable to open the file [%s]\n", output);
+        free_matrix(row.pixels);
+        free(writer.buffer);
+        close_reader(&reader);
+        close_input(imageFile);
+        return -4;
+    } // end Step 3
 
-    // step 5 - compare magic number with fil extension
-    if (strcmp(magicNumberString, "P1") == 0)
+    // Step 4 : header, the max color value of an encrypted P2 / P3 is only known at the end so a placeholder as wide as any 16 bits value is written
+    int patchMaxValue = !is_binary(row.magicNumber) && has_max_value(row.magicNumber);
+    unsigned int maxPossibleValue = row.maxPossibleValue;
+    unsigned int lines = row.lines;
+    unsigned short maxValue = 0;
+    if (patchMaxValue)
     {
-        if (strcmp(extension, "pbm") != 0)
-        {
-            printf("> 🔴 file extension [%s] does not match the magic number [P%d].\n", extension, (*image)->magicNumber + 1);
-            fclose(imageFile);
-            free_pnm(image);
-            return -2;
-        }
-        (*image)->magicNumber = P1;
+        row.maxPossibleValue = UINT16_MAX;
     }
-    else if (strcmp(magicNumberString, "P2") == 0)
+    writer.size = (size_t)(format_header(&row, writer.buffer) - writer.buffer);
+    off_t maxValueOffset = (off_t)writer.size - (MAX_VALUE_TEXT_LEN + 1);
+    row.lines = 1;
+    row.maxPossibleValue = maxPossibleValue;
+    // end Step 4
+
+    // Step 5 : read, encrypt and write the lines, one at a time or on the pipeline
+    int success = 1;
+    if (depth)
     {
-        if (strcmp(extension, "pgm") != 0)
-        {
-            printf("> 🔴 file extension [%s] does not match the magic number [P%d].\n", extension, (*image)->magicNumber + 1);
-            fclose(imageFile);
-            free_pnm(image);
-            return -2;
-        }
-        (*image)->magicNumber = P2;
+        PIPELINE pipeline;
+        pipeline.reader = &reader;
+        pipeline.input = input;
+        pipeline.lines = lines;
+        pipeline.breakPointLine = &breakPointLine;
+        pipeline.lfsr = lfsr;
+        success = run_pipeline(&pipeline, &row, &writer, lineLength, depth);
+        status = pipeline.status;
+        maxValue = pipeline.maxValue;
     }
-    else if (strcmp(magicNumberString, "P3") == 0)
+    for (unsigned int i = 0; success && !depth && i < lines; i++)
     {
-        if (strcmp(extension, "ppm") != 0)
+        if (is_binary(row.magicNumber) ? !store_raw_line(&reader, &row, 0, i) : !store_line(&reader, &row, 0, i, &breakPointLine))
         {
-            printf("> 🔴 file extension [%s] does not match the magic number [P%d].\n", extension, (*image)->magicNumber + 1);
-            fclose(imageFile);
-            free_pnm(image);
-            return -2;
+            fprintf(get_messages_stream(), "> 🔴 Error when storing the pixels around line %d in %s.\n", breakPointLine, input);
+            status = -3;
+            break;
         }
-        (*image)->magicNumber = P3;
+        unsigned short lineMax = encrypt_lines(&row, lfsr, NULL, 0, 1, row.pixels, row.stride);
+        if (lineMax > maxValue)
+        {
+            maxValue = lineMax;
+        }
+        // a failed flush leaves the buffer full, the lines left are not read
+        if (writer.capacity - writer.size < lineLength && !(success = flush_writer(&writer)))
+        {
+            break;
+        }
+        writer.size += format_line(&row, 0, writer.buffer + writer.size);
     }
-    else
+    success = success && flush_writer(&writer);
+    // end Step 5
+
+    // Step 6 : patch the placeholder, the digits are followed by spaces up to the width of the field (a pipe keeps 65535)
+    if (status == 0 && success && patchMaxValue && !standardOutput)
     {
-        printf("> 🔴 The magic number is unknown. Magic number found : [%s]\n", magicNumberString);
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
-    } // end step 4
+        char field[MAX_VALUE_TEXT_LEN];
+        memset(field, ' ', MAX_VALUE_TEXT_LEN);
+        format_unsigned(field, maxValue);
+        success = pwrite(writer.fd, field, MAX_VALUE_TEXT_LEN, maxValueOffset) == MAX_VALUE_TEXT_LEN;
+    } // end Step 6
 
-    // step 5 - Store number of columns and lines
-    if (!go_to_next_data(imageFile, &breakPointLine))
+    free_matrix(row.pixels);
+    free(writer.buffer);
+    close_reader(&reader);
+    close_input(imageFile);
+    if (close_output(writer.fd) != 0 || !success)
     {
-        printf("> 🔴 Unable to continue file read after magic number.\n");
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
+        fprintf(get_messages_stream(), "> 🔴 Unable to write the file [%s]\n", output);
+        status = -4;
     }
-    if (fscanf(imageFile, "%u %u", &(*image)->columns, &(*image)->lines) != 2)
+    if (status != 0)
     {
-        printf("> 🔴 Unable to find the number of columns and lines.\n");
-        fclose(imageFile);
-        free_pnm(image);
-        return -3;
+        // a truncated output would look like a valid image
+        if (!standardOutput)
+        {
+            unlink(output);
+        }
+        return status;
     }
-    // end step 5
 
-    // step 6 - Store the max color value
-    if ((*image)->magicNumber == P2 || (*image)->magicNumber == P3)
+    fprintf(get_messages_stream(), "> [Good news] Image stored in [%s].\n", output);
+    return 0;
+} // end pnm_file_encryption_stream()
+
+/**
+ * \fn static int skip_lines(READER *reader, PNM *header, unsigned int count, unsigned int *breakPointLine)
+ * \brief Go past lines of a pixels matrix without storing them, a binary matrix being skipped without being read.
+ *
+ * \param reader The reader on the file, at the beginning of a line of the matrix.
+ * \param header The header of the image.
+ * \param count The number of lines to skip.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre reader is instanced, header is instanced, breakPointLine is instanced.
+ * \post The playhead points after the lines.
+ *
+ * \return int 0 Error (missing pixels)
+ *             1 Success
+ */
+static int skip_lines(READER *reader, PNM *header, unsigned int count, unsigned int *breakPointLine)
+{
+    if (is_binary(header->magicNumber))
     {
-        if (!go_to_next_data(imageFile, &breakPointLine))
-        {
-            printf("> 🔴 Unable to continue file read after max color value\n");
-            fclose(imageFile);
-            free_pnm(image);
-            return -3;
-        }
-        if (fscanf(imageFile, "%u", &(*image)->maxPossibleValue) != 1)
+        return skip_bytes(reader, line_size(header_sample_width(header), samples_per_line(header)) * count);
+    }
+    size_t samples = (size_t)samples_per_line(header) * count;
+    unsigned int value;
+    for (size_t k = 0; k < samples; k++)
+    {
+        if (!go_to_next_data(reader, breakPointLine) || !read_unsigned(reader, &value))
         {
-            printf("> 🔴 Unable to find the max color value.\n");
-            fclose(imageFile);
-            free_pnm(image);
-            return -3;
+            return 0;
         }
-    } // end step 6
+    }
+    return 1;
+} // end skip_lines()
 
-    // step 7 - Store the pixels matrix
-    if (!store_pixels(imageFile, image, &breakPointLine))
+/**
+ * \fn static int read_index(char *imageName, PNM *header, size_t imageSize, unsigned int line, uint64_t *offset, uint64_t *check, unsigned int *indexedLine)
+ * \brief Find in the row index of an image the last line indexed up to a line, with a single read of the index.
+ *
+ * \param imageName The path of the image.
+ * \param header The header of the image.
+ * \param imageSize The size of the image file.
+ * \param line The line looked for.
+ * \param offset The address where to write the offset of the line found.
+ * \param check The address where to write the check of the text of the line found.
+ * \param indexedLine The address where to write the line found.
+ *
+ * \pre imageName, header, offset, check and indexedLine are instanced, line < header->lines.
+ *
+ * \return int 0 No index, or an index that doesn't describe this image
+ *             1 Success
+ */
+static int read_index(char *imageName, PNM *header, size_t imageSize, unsigned int line, uint64_t *offset, uint64_t *check, unsigned int *indexedLine)
+{
+    char *name = index_name(imageName);
+    FILE *indexFile = name ? fopen(name, "rb") : NULL;
+    free(name);
+    if (!indexFile)
     {
-        printf("> 🔴 Error when storing the pixels around line %d in %s.\n", breakPointLine, filename);
-        free_pnm(image);
-        fclose(imageFile);
-        return -3;
-    } // end step 7
+        return 0;
+    }
 
-    printf("> [Good news] Image successfully loaded.\n");
-    fclose(imageFile);
-    return 0;
-} // end load_pnm()
+    unsigned char head[INDEX_HEADER_SIZE];
+    unsigned char entry[INDEX_ENTRY_SIZE];
+    int found = fread(head, 1, INDEX_HEADER_SIZE, indexFile) == INDEX_HEADER_SIZE && memcmp(head, INDEX_MAGIC, strlen(INDEX_MAGIC)) == 0;
+    unsigned int step = found ? (unsigned int)load_little_endian(head + 8, sizeof(uint32_t)) : 0;
+    found = found && step > 0 && load_little_endian(head + 12, sizeof(uint32_t)) == header->lines &&
+            load_little_endian(head + 16, sizeof(uint64_t)) == imageSize;
+    found = found && fseek(indexFile, INDEX_HEADER_SIZE + (long)(line / step) * INDEX_ENTRY_SIZE, SEEK_SET) == 0 &&
+            fread(entry, 1, INDEX_ENTRY_SIZE, indexFile) == INDEX_ENTRY_SIZE;
+    fclose(indexFile);
+    if (found)
+    {
+        *offset = load_little_endian(entry, sizeof(uint64_t));
+        *check = load_little_endian(entry + 8, sizeof(uint64_t));
+        *indexedLine = line / step * step;
+    }
+    return found;
+} // end read_index()
 
-int write_pnm(PNM *image, char *filename)
+/**
+ * \fn static int seek_line(READER *reader, PNM *header, char *imageName, unsigned int line, unsigned int *breakPointLine)
+ * \brief Go to the beginning of a line of the pixels matrix : straight to it in a binary image, to the last line
+ *        indexed before it in an ASCII image with a row index (see write_pnm_indexed()), the lines left being tokenized.
+ *
+ * An entry of the index is trusted only if its offset is at the beginning of a line of the file, after the playhead,
+ * and if the text of that line has the check of the entry : otherwise the lines are tokenized from the playhead.
+ *
+ * \param reader The reader on the file, at the beginning of the first line of the matrix.
+ * \param header The header of the image.
+ * \param imageName The path of the image.
+ * \param line The line to reach.
+ * \param breakPointLine The current line in the file, not updated by a jump.
+ *
+ * \pre reader is instanced, header is instanced, imageName is instanced, line < header->lines.
+ * \post The playhead points to the beginning of the line.
+ *
+ * \return int 0 Error (missing pixels)
+ *             1 Success
+ */
+static int seek_line(READER *reader, PNM *header, char *imageName, unsigned int line, unsigned int *breakPointLine)
 {
-    assert(image && filename);
-
-    if (!check_file_name(filename))
+    uint64_t offset;
+    uint64_t check;
+    unsigned int indexedLine = 0;
+    size_t position = reader->mapping ? (size_t)(reader->buffer - reader->mapping) + reader->position : 0;
+    if (line > 0 && reader->mapping && !is_binary(header->magicNumber) && read_index(imageName, header, reader->mappingSize, line, &offset, &check, &indexedLine))
     {
-        printf("> 🔴 The file name [%s] isn't allowed. Tips : the file have to be in the same directory as the executable, it can't contains these characters : %s \n", filename, forbidenCharactersInFiles);
-        return -1;
+        const char *text = (const char *)reader->mapping + offset;
+        const char *lineEnd = offset >= position && offset > 0 && offset < reader->mappingSize && text[-1] == '\n' ? memchr(text, '\n', reader->mappingSize - offset) : NULL;
+        if (!lineEnd || line_check(text, (size_t)(lineEnd + 1 - text)) != check || !seek_reader(reader, (size_t)offset))
+        {
+            indexedLine = 0;
+        }
     }
+    return skip_lines(reader, header, line - indexedLine, breakPointLine);
+} // end seek_line()
 
-    FILE *fp = fopen(filename, "w");
-    if (!fp)
+/**
+ * \fn static int open_image(char *input, FILE **imageFile, READER *reader, PNM *header, unsigned int *breakPointLine)
+ * \brief Open an image and read its header, up to the first byte of its pixels matrix.
+ *
+ * \param input The path of the image, "-" for the standard input.
+ * \param imageFile The address where to write the file opened.
+ * \param reader The reader to open on the file.
+ * \param header The image struct receiving the header.
+ * \param breakPointLine The current line in the file.
+ *
+ * \pre input, imageFile, reader, header and breakPointLine are instanced.
+ * \post The playhead points to the pixels matrix, the file and the reader have to be closed (nothing is left open in case of error).
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation or unable to open input
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ */
+static int open_image(char *input, FILE **imageFile, READER *reader, PNM *header, unsigned int *breakPointLine)
+{
+    char *extension = NULL;
+    if (!is_standard_stream(input) && !(extension = get_file_extension(input)))
     {
-        printf("> 🔴 Unable to open the file [%s]\n", filename);
+        fprintf(get_messages_stream(), "> 🔴 Unable to get the file extension: [%s]\n", input);
         return -2;
     }
-
-    // line 1 : magic number
-    switch (image->magicNumber)
+    *imageFile = is_standard_stream(input) ? stdin : fopen(input, "r");
+    if (!*imageFile)
     {
-    case P1:
-        fprintf(fp, "P1\n");
-        break;
-    case P2:
-        fprintf(fp, "P2\n");
-        break;
-    case P3:
-        fprintf(fp, "P3\n");
-        break;
-    } // end line 1
+        fprintf(get_messages_stream(), "> 🔴 Unable to open the file [%s].\n", input);
+        return -1;
+    }
+    if (!open_reader(reader, *imageFile))
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to read the file.\n");
+        close_input(*imageFile);
+        return -1;
+    }
+    int status = read_header(reader, header, extension, breakPointLine);
+    if (status == 0 && is_binary(header->magicNumber) && !read_raw_separator(reader, header, breakPointLine))
+    {
+        status = -3;
+    }
+    if (status != 0)
+    {
+        close_reader(reader);
+        close_input(*imageFile);
+    }
+    return status;
+} // end open_image()
 
-    // line 2 : number of columns and lines
-    fprintf(fp, "%u %u\n", image->columns, image->lines);
+int load_pnm_rows(PNM **image, char *filename, unsigned int firstLine, unsigned int count)
+{
+    assert(image && filename);
 
-    // line 3 : max number for colors encoding
-    if (image->magicNumber == P2 || image->magicNumber == P3)
+    // Step 1 : open the file and check the range of lines
+    FILE *imageFile;
+    READER reader;
+    PNM header;
+    unsigned int breakPointLine = 1;
+    int status = open_image(filename, &imageFile, &reader, &header, &breakPointLine);
+    if (status != 0)
     {
-        fprintf(fp, "%d\n", image->maxPossibleValue);
+        return status;
     }
+    if (count == 0 || firstLine >= header.lines || count > header.lines - firstLine)
+    {
+        fprintf(get_messages_stream(), "> 🔴 The lines [%u, %u[ are not inside the image (%u lines).\n", firstLine, firstLine + count, header.lines);
+        close_reader(&reader);
+        close_input(imageFile);
+        return -5;
+    } // end Step 1
 
-    // lines > 3 : matrix lines
-    unsigned int linesLength = image->columns;
-    if (image->magicNumber == P3)
+    // Step 2 : the image holds the lines of the range
+    *image = malloc(sizeof(PNM));
+    if (*image)
     {
-        linesLength *= 3;
+        **image = header;
+        (*image)->lines = count;
+        (*image)->sampleWidth = header_sample_width(*image);
+        (*image)->pixels = create_matrix(count, line_size((*image)->sampleWidth, samples_per_line(*image)), &(*image)->stride);
     }
-    for (unsigned int i = 0; i < image->lines; i++)
+    if (!*image || !(*image)->pixels)
     {
-        for (unsigned int j = 0; j < linesLength; j++)
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space for the image.\n");
+        if (*image)
+        {
+            free_pnm(image);
+        }
+        close_reader(&reader);
+        close_input(imageFile);
+        return -1;
+    } // end Step 2
+
+    // Step 3 : seek the first line, then store the lines of the range (the lines below are never read)
+    if (!seek_line(&reader, &header, filename, firstLine, &breakPointLine))
+    {
+        status = -3;
+    }
+    for (unsigned int i = 0; status == 0 && i < count; i++)
+    {
+        if (is_binary(header.magicNumber) ? !store_raw_line(&reader, *image, i, firstLine + i) : !store_line(&reader, *image, i, firstLine + i, &breakPointLine))
         {
-            fprintf(fp, "%hu ", (unsigned short)image->pixels[i][j]);
+            status = -3;
         }
-        fprintf(fp, "\n");
-    } // end line 3
+    }
+    close_reader(&reader);
+    close_input(imageFile);
+    if (status != 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Error when storing the pixels around line %d in %s.\n", breakPointLine, filename);
+        free_pnm(image);
+        return status;
+    } // end Step 3
 
-    printf("> [Good news] Image stored in [%s].\n", filename);
-    fclose(fp);
     return 0;
-} // end write_pnm()
+} // end load_pnm_rows()
 
-void pnm_file_encryption(PNM *image, LFSR *lfsr)
+int pnm_file_crop(char *input, char *output, LFSR *lfsr, unsigned int x, unsigned int y, unsigned int width, unsigned int height, size_t *samples)
 {
-    assert(image && lfsr);
+    assert(input && output && lfsr);
 
-    unsigned int columns = image->columns;
-    if (image->magicNumber == P3)
+    // Step 1 : check the file names, then open the input and read its header
+    if (!is_standard_stream(output) && !check_file_name(output))
     {
-        columns *= 3;
+        fprintf(get_messages_stream(), "> 🔴 The file name [%s] isn't allowed. Tips : the file have to be in the same directory as the executable, it can't contains these characters : %s \n", output, forbidenCharactersInFiles);
+        return -2;
     }
+    FILE *imageFile;
+    READER reader;
+    PNM row;
+    unsigned int breakPointLine = 1;
+    int status = open_image(input, &imageFile, &reader, &row, &breakPointLine);
+    if (status != 0)
+    {
+        return status;
+    }
+    if (width == 0 || height == 0 || x >= row.columns || y >= row.lines || width > row.columns - x || height > row.lines - y)
+    {
+        fprintf(get_messages_stream(), "> 🔴 The rectangle [%u, %u, %u, %u] is not inside the image (%u x %u).\n", x, y, width, height, row.columns, row.lines);
+        close_reader(&reader);
+        close_input(imageFile);
+        return -5;
+    } // end Step 1
 
-    unsigned short maxValue = 0;
-
-    for (unsigned int i = 0; i < image->lines; i++)
+    // Step 2 : a one line image holds a whole line of the file, the tile receives the samples of the rectangle
+    unsigned int samplesPerPixel = samples_per_line(&row) / row.columns;
+    row.sampleWidth = is_binary(row.magicNumber) ? header_sample_width(&row) : SHORT_SAMPLES;
+    row.pixels = create_matrix(1, line_size(row.sampleWidth, samples_per_line(&row)), &row.stride);
+    PNM *tile = malloc(sizeof(PNM));
+    if (tile)
     {
-        for (unsigned int j = 0; j < columns; j++)
+        *tile = row;
+        tile->columns = width;
+        tile->lines = height;
+        tile->pixels = create_matrix(height, line_size(tile->sampleWidth, samples_per_line(tile)), &tile->stride);
+    }
+    if (!row.pixels || !tile || !tile->pixels)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to crop the file.\n");
+        free_matrix(row.pixels);
+        if (tile)
         {
+            free_pnm(&tile);
+        }
+        close_reader(&reader);
+        close_input(imageFile);
+        return -1;
+    } // end Step 2
 
-            unsigned int valueGenerated = generation(lfsr, 32);
-            image->pixels[i][j] = image->pixels[i][j] ^ valueGenerated;
+    // Step 3 : seek the first line of the rectangle, then copy the samples of the rectangle line by line (the lines below are never read)
+    if (!seek_line(&reader, &row, input, y, &breakPointLine))
+    {
+        status = -3;
+    }
+    row.lines = 1;
+    unsigned int first = x * samplesPerPixel;
+    unsigned int count = width * samplesPerPixel;
+    for (unsigned int i = 0; status == 0 && i < height; i++)
+    {
+        if (is_binary(row.magicNumber) ? !store_raw_line(&reader, &row, 0, y + i) : !store_line(&reader, &row, 0, y + i, &breakPointLine))
+        {
+            status = -3;
+            break;
+        }
+        unsigned char *source = pixels_line(&row, 0);
+        unsigned char *destination = pixels_line(tile, i);
+        for (unsigned int j = 0; j < count; j++)
+        {
+            write_sample(destination, tile->sampleWidth, j, read_sample(source, row.sampleWidth, first + j));
+        }
+    }
+    free_matrix(row.pixels);
+    close_reader(&reader);
+    close_input(imageFile);
+    if (status != 0)
+    {
+        fprintf(get_messages_stream(), "> 🔴 Error when storing the pixels around line %d in %s.\n", breakPointLine, input);
+        free_pnm(&tile);
+        return status;
+    } // end Step 3
 
-            if (image->magicNumber == P2 || image->magicNumber == P3)
-            {
-                if ((unsigned short)image->pixels[i][j] > maxValue)
-                {
-                    maxValue = (unsigned short)image->pixels[i][j];
-                }
-            }
+    // Step 4 : each line of the tile is XORed with the keystream from the sample of the file it comes from, the lfsr
+    //          jumps over the samples outside the rectangle
+    uint64_t samplesPerLine = (uint64_t)samples_per_line(&row);
+    uint64_t position = 0;
+    unsigned short maxValue = 0;
+    for (unsigned int i = 0; status == 0 && i < height; i++)
+    {
+        uint64_t target = (uint64_t)(y + i) * samplesPerLine + first;
+        if (lfsr_jump(lfsr, (target - position) * 32) != 0)
+        {
+            fprintf(get_messages_stream(), "> 🔴 Unable to allocate memory space to crop the file.\n");
+            status = -1;
+            break;
+        }
+        unsigned short lineMax = encrypt_lines(tile, lfsr, NULL, i, i + 1, tile->pixels, tile->stride);
+        if (lineMax > maxValue)
+        {
+            maxValue = lineMax;
         }
+        position = target + count;
     }
+    // the max color value of an ASCII tile is the one of its samples, as for an image decrypted whole
+    store_encrypted_matrix(tile, tile->pixels, tile->stride, maxValue);
+    // end Step 4
 
-    if (image->magicNumber == P2 || image->magicNumber == P3)
+    // Step 5 : the tile is a standalone image
+    if (status == 0 && write_pnm(tile, output) != 0)
     {
-        image->maxPossibleValue = (unsigned int)maxValue;
+        status = -4;
     }
-} // end pnm_file_encryption()
+    if (status == 0 && samples)
+    {
+        *samples = get_samples_count(tile);
+    }
+    free_pnm(&tile);
+    return status;
+} // end pnm_file_crop()
 
 void free_pnm(PNM **image)
 {
     assert(*image);
     if ((*image)->pixels)
     {
-        unsigned int linesLength = (*image)->columns;
-        if ((*image)->magicNumber == P3)
-            linesLength *= 3;
-        free_matrix((*image)->pixels, (*image)->lines);
+        free_matrix((*image)->pixels);
         (*image)->pixels = NULL;
     }
     free(*image);
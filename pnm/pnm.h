@@ -21,16 +21,19 @@ typedef struct PNM_t PNM;
  * Enumeration of all possible magic numbers
  */
 typedef enum MAGIC_NUMBERS_t { 
-    P1,
-    P2,
-    P3
+    P1, /*!< ASCII bitmap (pbm) */
+    P2, /*!< ASCII graymap (pgm) */
+    P3, /*!< ASCII pixmap (ppm) */
+    P4, /*!< Binary bitmap (pbm) */
+    P5, /*!< Binary graymap (pgm), 16 bits big-endian samples when the max color value is > 255 */
+    P6  /*!< Binary pixmap (ppm), 16 bits big-endian samples when the max color value is > 255 */
 } MAGIC_NUMBERS;
 
 /**
  * \brief Loads a PNM image from a file.
  *
  * \param image The address of a PNM pointer to which to write the content of the file filename.
- * \param filename The path to the file containing the image.
+ * \param filename The path to the file containing the image, "-" to read the standard input (the format is then given by the magic number only).
  *
  * \pre image is instanced, filename is instanced
  * \post image points to the image loaded from the file.
@@ -42,11 +45,35 @@ typedef enum MAGIC_NUMBERS_t {
  */
 int load_pnm(PNM** image, char* filename);
 
+/**
+ * \brief Loads a PNM image from a file, the ASCII pixels matrix of a large file being tokenized on several threads.
+ *
+ * The matrix is split in chunks at line breaks, the samples of each chunk are counted and a prefix sum of the counts
+ * places each chunk in the pixels matrix. The result and the errors are the ones of load_pnm() (a malformed matrix
+ * is parsed again sequentially to report its error). P1 images, binary images and the standard input are loaded
+ * on a single thread.
+ *
+ * \param image The address of a PNM pointer to which to write the content of the file filename.
+ * \param filename The path to the file containing the image, "-" to read the standard input.
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, filename is instanced, threadsCount > 0.
+ * \post image points to the image loaded from the file.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ */
+int load_pnm_parallel(PNM **image, char *filename, unsigned int threadsCount);
+
 /**
  * \brief Saves a PNM image to a file.
  *
+ * A row index left next to the file by write_pnm_indexed() is removed.
+ *
  * \param image Pointer on PNM.
- * \param filename File path of the destination.
+ * \param filename File path of the destination, "-" to write on the standard output.
  *
  * \pre image is instanced, filename is instanced.
  * \post The file filename contain the informations of PNM image.
@@ -57,16 +84,214 @@ int load_pnm(PNM** image, char* filename);
  */
 int write_pnm(PNM* image, char* filename);
 
+/**
+ * \brief Saves a PNM image to a file, the pixels matrix of a large image being formatted on several threads.
+ *
+ * The lines are split in one block per thread. The length of each block once formatted is computed first, the
+ * prefix sum of the lengths gives the position of each block in the file, then each thread formats its block in a
+ * buffer of its own and writes it at its position with pwrite(). The file is byte-identical to the one of write_pnm().
+ * The standard output is written on a single thread.
+ *
+ * \param image Pointer on PNM.
+ * \param filename File path of the destination, "-" to write on the standard output.
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, filename is instanced, threadsCount > 0.
+ * \post The file filename contain the informations of PNM image.
+ *
+ * \return  int 0 Success
+ *             -1 Name of file is malformed
+ *             -2 Error of file manipulation
+ */
+int write_pnm_parallel(PNM *image, char *filename, unsigned int threadsCount);
+
+/**
+ * \brief Saves a PNM image to a file like write_pnm_parallel(), with a row index next to an ASCII image.
+ *
+ * The index filename.idx holds the offset in the file of every indexStep-th line of the pixels matrix, so that
+ * load_pnm_rows() and pnm_file_crop() go straight to a line instead of tokenizing the lines above it. Its header
+ * (the magic "PNMIDX02", the step and the number of lines on 4 bytes, the size of the image on 8 bytes) is followed
+ * by one entry per line indexed : its offset and a FNV-1a hash of its text on 8 bytes, all little-endian. An entry
+ * is used only if its offset is at the beginning of a line whose text has this hash. No index is written for a
+ * binary image, whose lines are at fixed offsets, nor for the standard output. Writing an image (with any of the
+ * write functions) removes the index left next to it by a previous write.
+ *
+ * \param image Pointer on PNM.
+ * \param filename File path of the destination, "-" to write on the standard output.
+ * \param threadsCount The number of threads to use.
+ * \param indexStep The number of lines between two lines indexed, 0 to write no index.
+ *
+ * \pre image is instanced, filename is instanced, threadsCount > 0.
+ * \post The file filename contain the informations of PNM image, filename.idx its row index.
+ *
+ * \return  int 0 Success
+ *             -1 Name of file is malformed
+ *             -2 Error of file manipulation
+ */
+int write_pnm_indexed(PNM *image, char *filename, unsigned int threadsCount, unsigned int indexStep);
+
+/**
+ * \brief Get a sample of the pixels matrix.
+ *
+ * \param image The image.
+ * \param line The index of the line.
+ * \param sample The index of the sample in the line (a P3 pixel is made of 3 samples).
+ *
+ * \pre image is instanced, line and sample are inside the pixels matrix.
+ * \post The sample is returned.
+ *
+ * \return unsigned int The sample (samples are stored on at most 16 bits, as they are written).
+ */
+unsigned int get_sample(PNM *image, unsigned int line, unsigned int sample);
+
 /**
  * \brief Encrypt a pnm file with using the lfsr cipher
  *
+ * Every sample consumes a 32 bits keystream word. The samples of an ASCII image (P1, P2, P3) become the 16 low
+ * bits of sample ^ word and the max color value is the max of the encrypted samples. The samples of a binary
+ * image (P4, P5, P6) are XORed with the low bits of the word that fit in their width (1, 8 or 16 bits) and the
+ * max color value is kept, so that the file keeps its layout.
+ *
  * \param image The image to encrypt.
  * \param lfsr The lfsr instance use to encrypt the file
  *
  * \pre image is instanced, lfsr is instanced.
  * \post The image pixels matrix is encrypted
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation (the image is left unchanged)
+ */
+int pnm_file_encryption(PNM* image, LFSR* lfsr);
+
+/**
+ * \brief Encrypt a pnm file using the lfsr cipher on several threads.
+ *
+ * The lines are split in contiguous blocks, one per thread. Each thread positions its own copy of the lfsr
+ * at the keystream offset of its first line, so the result is identical to pnm_file_encryption() whatever
+ * the number of threads.
+ *
+ * \param image The image to encrypt.
+ * \param lfsr The lfsr instance use to encrypt the file
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, lfsr is instanced, threadsCount > 0.
+ * \post The image pixels matrix is encrypted, lfsr is in the state pnm_file_encryption() would leave it.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation (the image is left unchanged)
+ */
+int pnm_file_encryption_parallel(PNM *image, LFSR *lfsr, unsigned int threadsCount);
+
+/**
+ * \brief Encrypt a pnm file with a precomputed keystream, on several threads.
+ *
+ * Gives the same result as pnm_file_encryption() with the lfsr that generated the keystream.
+ *
+ * \param image The image to encrypt.
+ * \param keystream The keystream, one 32 bits word per sample (see get_samples_count()).
+ * \param threadsCount The number of threads to use.
+ *
+ * \pre image is instanced, keystream holds get_samples_count(image) words, threadsCount > 0.
+ * \post The image pixels matrix is encrypted.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation (the image is left unchanged)
+ */
+int pnm_file_encryption_keystream(PNM *image, const uint32_t *keystream, unsigned int threadsCount);
+
+/**
+ * \brief Get the number of samples of an image, i.e. the number of keystream words its encryption consumes.
+ *
+ * \param image The image.
+ *
+ * \pre image is instanced.
+ * \post The number of samples is returned.
+ *
+ * \return size_t The number of samples (3 per pixel for P3 and P6).
+ */
+size_t get_samples_count(PNM *image);
+
+/**
+ * \brief Encrypt a pnm file into another one, one line at a time.
+ *
+ * The lines are read, encrypted and written one after the other, so the memory used depends on the width of
+ * the image only. The output holds the same samples as load_pnm(), pnm_file_encryption() and write_pnm() would
+ * give. The header of an encrypted P2 / P3 is written before the max color value is known : its field is as
+ * wide as "65535" and is patched at the end, the digits being followed by spaces (e.g. "255  \n").
+ *
+ * With a depth, the lines are read, encrypted and written by three threads (the caller being the writer) handing
+ * bands of lines to each other through lock-free queues of depth bands, so the reads, the encryption and the
+ * writes overlap. A full queue holds back the stage feeding it, the memory used stays bounded.
+ *
+ * \param input The path to the file containing the image, "-" to read the standard input (the format is then given by the magic number only).
+ * \param output File path of the destination, "-" to write on the standard output (the max color value of a P2 / P3 then stays 65535).
+ * \param lfsr The lfsr instance use to encrypt the file
+ * \param depth The capacity of the queues between the stages, 0 to process the lines in the calling thread.
+ *
+ * \pre input is instanced, output is instanced, lfsr is instanced.
+ * \post The file output contains the encrypted image. It is removed in case of error.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation or unable to open input
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ *             -4 Error of file manipulation
+ */
+int pnm_file_encryption_stream(char *input, char *output, LFSR *lfsr, unsigned int depth);
+
+/**
+ * \brief Decrypt (or encrypt) a rectangle of a pnm file into a standalone image.
+ *
+ * Only the lines down to the bottom of the rectangle are read : the lines above it are skipped (without being read
+ * for a binary image, from the last line indexed before it for an ASCII image with a row index), a line of the rectangle is read whole and its samples inside the rectangle are kept. The lfsr
+ * then jumps (see lfsr_jump()) to the keystream of the first sample of the rectangle in each line, so the keystream
+ * generated grows with the size of the rectangle, not with the size of the image. The tile holds the samples the
+ * decryption of the whole image would give inside the rectangle, the max color value of an ASCII tile is the max of
+ * its samples.
+ *
+ * \param input The path to the file containing the image, "-" to read the standard input.
+ * \param output File path of the destination, "-" to write on the standard output.
+ * \param lfsr The lfsr instance used to encrypt the file, positioned at the beginning of the keystream.
+ * \param x The first column of the rectangle.
+ * \param y The first line of the rectangle.
+ * \param width The number of columns of the rectangle.
+ * \param height The number of lines of the rectangle.
+ * \param samples Receives the number of samples of the tile (see get_samples_count()), NULL when not needed.
+ *
+ * \pre input is instanced, output is instanced, lfsr is instanced.
+ * \post The file output contains the decrypted rectangle, *samples its number of samples on success.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation or unable to open input
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ *             -4 Error of file manipulation
+ *             -5 The rectangle is empty or not inside the image
+ */
+int pnm_file_crop(char *input, char *output, LFSR *lfsr, unsigned int x, unsigned int y, unsigned int width, unsigned int height, size_t *samples);
+
+/**
+ * \brief Loads a range of lines of a PNM image from a file.
+ *
+ * The lines above the range are skipped without being read for a binary image, from the last line indexed before the
+ * range for an ASCII image with a row index (see write_pnm_indexed()) ; an index or an entry of the index that
+ * doesn't match the file is ignored. The lines below the range are never read.
+ *
+ * \param image The address of a PNM pointer to which to write the lines, its header tells count lines.
+ * \param filename The path to the file containing the image, "-" to read the standard input.
+ * \param firstLine The first line of the range.
+ * \param count The number of lines of the range.
+ *
+ * \pre image is instanced, filename is instanced.
+ * \post image points to an image holding the lines of the range.
+ *
+ * \return int 0 Success
+ *             -1 Error in memory allocation or unable to open input
+ *             -2 Name of file is malformed
+ *             -3 Content of file is malformed
+ *             -5 The range is empty or not inside the image
  */
-void pnm_file_encryption(PNM* image, LFSR* lfsr);
+int load_pnm_rows(PNM **image, char *filename, unsigned int firstLine, unsigned int count);
 
 /**
  * \brief Free a pointer on PNM
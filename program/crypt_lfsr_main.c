@@ -6,6 +6,8 @@
  * \version: V2
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -13,50 +15,669 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 
 #include "../pnm/pnm.h"
 #include "../utils/utils.h"
 #include "../lfsr/lfsr.h"
+#include "../keystream/keystream.h"
+
+/**
+ * \def MANIFEST_PATH_LEN
+ * @brief The maximum length of a path in a manifest.
+ */
+#define MANIFEST_PATH_LEN 4096
+
+/**
+ * \def DEFAULT_CACHE_MEGABYTES
+ * @brief The default maximum size of the keystream cache, in megabytes.
+ */
+#define DEFAULT_CACHE_MEGABYTES 1024
+
+/**
+ * \def DEFAULT_QUEUE_DEPTH
+ * @brief The default number of bands queued between the stages of the streaming pipeline.
+ */
+#define DEFAULT_QUEUE_DEPTH 4
+
+/**
+ * \enum STAGES
+ * \brief The stages of an encryption measured by --stats.
+ */
+typedef enum
+{
+   STAGE_LOAD,       /*!< load_pnm() */
+   STAGE_ENCRYPTION, /*!< The encryption, with the loading of the cached keystream */
+   STAGE_WRITE,      /*!< write_pnm() */
+   STAGE_STREAM,     /*!< pnm_file_encryption_stream(), the three stages overlapped or interleaved */
+   STAGE_CROP,       /*!< pnm_file_crop() */
+   STAGES_COUNT
+} STAGES;
+
+/**
+ * \var STAGE_NAMES
+ * @brief The names of the stages in the statistics, indexed by STAGES.
+ */
+static const char *STAGE_NAMES[STAGES_COUNT] = {"load", "encryption", "write", "stream", "crop"};
+
+/**
+ * \struct STAMP_t
+ * \brief  A point in time, or a duration, on the wall clock and on the cpu clock.
+ */
+typedef struct STAMP_t
+{
+   double wall; /*!< The monotonic clock, in seconds. */
+   double cpu;  /*!< The cpu clock, in seconds. */
+} STAMP;
+
+/**
+ * \struct STATS_t
+ * \brief  The statistics of the run, printed by --stats. The encryptions take them NULL when the option is off.
+ */
+typedef struct STATS_t
+{
+   clockid_t cpuClock;           /*!< The process clock for a single file, the clock of each worker in a batch. */
+   pthread_mutex_t lock;         /*!< Protects the fields below, shared by the workers. */
+   STAMP stages[STAGES_COUNT];   /*!< The time spent in each stage, summed over the files. */
+   unsigned int files;           /*!< The number of files encrypted. */
+   uint64_t bytesRead;           /*!< The size of the input files. */
+   uint64_t bytesWritten;        /*!< The size of the output files. */
+   uint64_t samples;             /*!< The number of samples encrypted. */
+} STATS;
+
+/**
+ * \var countAllocations
+ * @brief Set by --stats, the allocations are only counted when it is set.
+ */
+static int countAllocations = 0;
+
+/**
+ * \var allocations
+ * @brief The number of calls to malloc(), calloc() and realloc() made by the program and its libraries.
+ */
+static uint64_t allocations = 0;
+
+// the program is linked with --wrap, the calls of every object file and library land here
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+   if (countAllocations)
+   {
+      __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+   }
+   return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+   if (countAllocations)
+   {
+      __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+   }
+   return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+   if (countAllocations)
+   {
+      __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+   }
+   return __real_realloc(pointer, size);
+}
+
+/**
+ * \fn static STAMP stamp_now(clockid_t cpuClock)
+ * \brief Read the wall clock and a cpu clock.
+ *
+ * \param cpuClock The cpu clock to read.
+ *
+ * \return STAMP The current time.
+ */
+static STAMP stamp_now(clockid_t cpuClock)
+{
+   struct timespec wall;
+   struct timespec cpu;
+   clock_gettime(CLOCK_MONOTONIC, &wall);
+   clock_gettime(cpuClock, &cpu);
+   STAMP stamp = {wall.tv_sec + wall.tv_nsec * 1e-9, cpu.tv_sec + cpu.tv_nsec * 1e-9};
+   return stamp;
+} // end stamp_now()
+
+/**
+ * \fn static void end_stage(STATS *stats, STAGES stage, STAMP *start)
+ * \brief Add the time elapsed since start to a stage, then restart the stamp for the next stage.
+ *
+ * \param stats The statistics.
+ * \param stage The stage that ends.
+ * \param start The beginning of the stage, set to the current time.
+ *
+ * \pre stats and start are instanced.
+ * \post The stage duration is added to the statistics.
+ */
+static void end_stage(STATS *stats, STAGES stage, STAMP *start)
+{
+   STAMP end = stamp_now(stats->cpuClock);
+   pthread_mutex_lock(&stats->lock);
+   stats->stages[stage].wall += end.wall - start->wall;
+   stats->stages[stage].cpu += end.cpu - start->cpu;
+   pthread_mutex_unlock(&stats->lock);
+   *start = end;
+} // end end_stage()
+
+/**
+ * \fn static void count_file(STATS *stats, char *input, char *output, uint64_t samples)
+ * \brief Add an encrypted file to the statistics.
+ *
+ * \param stats The statistics.
+ * \param input The path to the image read.
+ * \param output The path to the image written.
+ * \param samples The number of samples of the image.
+ *
+ * \pre stats, input and output are instanced.
+ * \post The sizes of the files and the samples are added to the statistics.
+ */
+static void count_file(STATS *stats, char *input, char *output, uint64_t samples)
+{
+   struct stat inputStatus;
+   struct stat outputStatus;
+   uint64_t read = stat(input, &inputStatus) == 0 ? (uint64_t)inputStatus.st_size : 0;
+   uint64_t written = stat(output, &outputStatus) == 0 ? (uint64_t)outputStatus.st_size : 0;
+   pthread_mutex_lock(&stats->lock);
+   stats->files++;
+   stats->bytesRead += read;
+   stats->bytesWritten += written;
+   stats->samples += samples;
+   pthread_mutex_unlock(&stats->lock);
+} // end count_file()
+
+/**
+ * \fn static void print_stats(STATS *stats, STAMP *start)
+ * \brief Print the statistics of the run as a single JSON line on stderr.
+ *
+ * \param stats The statistics.
+ * \param start The beginning of the run, on the process cpu clock.
+ *
+ * \pre stats and start are instanced, every lfsr is freed.
+ * \post The line is printed.
+ */
+static void print_stats(STATS *stats, STAMP *start)
+{
+   STAMP end = stamp_now(CLOCK_PROCESS_CPUTIME_ID);
+   struct rusage usage;
+   long peakKilobytes = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+
+   fprintf(stderr, "{\"wall_s\": %.6f, \"cpu_s\": %.6f, \"stages\": {", end.wall - start->wall, end.cpu - start->cpu);
+   for (unsigned int s = 0; s < STAGES_COUNT; s++)
+   {
+      fprintf(stderr, "%s\"%s\": {\"wall_s\": %.6f, \"cpu_s\": %.6f}", s ? ", " : "", STAGE_NAMES[s], stats->stages[s].wall, stats->stages[s].cpu);
+   }
+   fprintf(stderr, "}, \"files\": %u, \"bytes_read\": %llu, \"bytes_written\": %llu, \"samples\": %llu, \"lfsr_steps\": %llu, \"allocations\": %llu, \"peak_rss_kb\": %ld}\n",
+           stats->files, (unsigned long long)stats->bytesRead, (unsigned long long)stats->bytesWritten, (unsigned long long)stats->samples,
+           (unsigned long long)get_freed_steps(), (unsigned long long)__atomic_load_n(&allocations, __ATOMIC_RELAXED), peakKilobytes);
+} // end print_stats()
+
+/**
+ * \struct CACHE_t
+ * \brief  The keystream cache used by the encryption of loaded images.
+ */
+typedef struct CACHE_t
+{
+   char *directory;   /*!< The cache directory, NULL without cache. */
+   uint64_t maxBytes; /*!< The maximum size of the cache. */
+} CACHE;
+
+/**
+ * \struct CROP_t
+ * \brief  The rectangle of the images to decrypt, given by --crop.
+ */
+typedef struct CROP_t
+{
+   int enabled;         /*!< Decrypt the rectangle only. */
+   unsigned int x;      /*!< The first column of the rectangle. */
+   unsigned int y;      /*!< The first line of the rectangle. */
+   unsigned int width;  /*!< The number of columns of the rectangle. */
+   unsigned int height; /*!< The number of lines of the rectangle. */
+} CROP;
+
+/**
+ * \struct BATCH_t
+ * \brief  The files of a batch, shared by the workers.
+ */
+typedef struct BATCH_t
+{
+   char **inputs;           /*!< The input files. */
+   char **outputs;          /*!< The output files, outputs[i] receives the encryption of inputs[i]. */
+   unsigned int count;      /*!< The number of files. */
+   unsigned int next;       /*!< The index of the next file to encrypt. */
+   pthread_mutex_t lock;    /*!< Protects next. */
+   LFSR *lfsr;              /*!< The lfsr built from the seed, copied by the workers and never stepped. */
+   int stream;              /*!< Encrypt the files in streaming. */
+   CACHE cache;             /*!< The keystream cache. */
+   CROP crop;               /*!< The rectangle to decrypt in each file. */
+   unsigned int indexStep;  /*!< The lines between two lines of the row index of an ASCII output, 0 for none. */
+   int *failed;             /*!< failed[i] is set when the encryption of inputs[i] failed. */
+   STATS *stats;            /*!< The statistics, NULL without --stats. */
+} BATCH;
+
+/**
+ * \fn static int encrypt_file(char *input, char *output, LFSR *lfsr, int stream, unsigned int queueDepth, CACHE *cache, CROP *crop, unsigned int indexStep, unsigned int threadsCount, STATS *stats)
+ * \brief Encrypt an image file into another one.
+ *
+ * \param input The path to the image to encrypt.
+ * \param output The path of the encrypted image.
+ * \param lfsr The lfsr, positioned at the beginning of the keystream.
+ * \param stream Encrypt the lines one at a time instead of loading the whole image.
+ * \param queueDepth The depth of the queues of the streaming pipeline, 0 to stream in the calling thread.
+ * \param cache The keystream cache, used for a loaded image.
+ * \param crop The rectangle to decrypt, the whole image when it isn't enabled.
+ * \param indexStep The number of lines between two lines of the row index written next to an ASCII output, 0 for no index.
+ * \param threadsCount The number of threads of the loading, the encryption and the writing of an image.
+ * \param stats The statistics of the run, NULL to skip the measures.
+ *
+ * \pre input, output, lfsr, cache and crop are instanced, threadsCount > 0, lfsr has not been stepped.
+ * \post The file output contains the encrypted image, its measures are added to stats.
+ *
+ * \return int 0 Error
+ *             1 Success
+ */
+static int encrypt_file(char *input, char *output, LFSR *lfsr, int stream, unsigned int queueDepth, CACHE *cache, CROP *crop, unsigned int indexStep, unsigned int threadsCount, STATS *stats)
+{
+   // a standard stream has no extension, the library checks the magic number of the input
+   int standardStream = is_standard_stream(input) || is_standard_stream(output);
+   char *inputExtension = standardStream ? NULL : get_file_extension(input);
+   char *outputExtension = standardStream ? NULL : get_file_extension(output);
+   if (!standardStream && (!inputExtension || !outputExtension || strcmp(inputExtension, outputExtension)))
+   {
+      fprintf(get_messages_stream(), "> 🔴 The input file [%s] and the output file [%s] do not agree on the image format.\n", input, output);
+      return 0;
+   }
+   STAMP stamp;
+   if (stats)
+   {
+      stamp = stamp_now(stats->cpuClock);
+   }
+
+   // crop : only the lines down to the rectangle are read, the keystream jumps to the rectangle in each line
+   if (crop->enabled)
+   {
+      size_t samples;
+      if (pnm_file_crop(input, output, lfsr, crop->x, crop->y, crop->width, crop->height, &samples) != 0)
+      {
+         fprintf(get_messages_stream(), "> 🔴 Unable to decrypt the rectangle of the file [%s] in [%s].\n", input, output);
+         return 0;
+      }
+      if (stats)
+      {
+         // only the samples of the tile are decrypted, the ones the lfsr jumps over aren't counted
+         end_stage(stats, STAGE_CROP, &stamp);
+         count_file(stats, input, output, samples);
+      }
+      return 1;
+   }
+
+   // streaming : the lines are encrypted and written as they are read
+   if (stream)
+   {
+      if (pnm_file_encryption_stream(input, output, lfsr, queueDepth) != 0)
+      {
+         fprintf(get_messages_stream(), "> 🔴 Unable to encrypt the file [%s] in [%s].\n", input, output);
+         return 0;
+      }
+      if (stats)
+      {
+         // every sample takes a 32 bits word of the keystream
+         end_stage(stats, STAGE_STREAM, &stamp);
+         count_file(stats, input, output, get_steps(lfsr) / 32);
+      }
+      return 1;
+   }
+
+   // Step 1 : file processing
+   PNM *image;
+   if (load_pnm_parallel(&image, input, threadsCount) != 0)
+   {
+      fprintf(get_messages_stream(), "> 🔴 Unable to load the file [%s].\n", input);
+      return 0;
+   }
+   if (stats)
+   {
+      end_stage(stats, STAGE_LOAD, &stamp);
+   }
+
+   // Step 2 : encryption of the file, with the cached keystream if there is one
+   KEYSTREAM *keystream = cache->directory ? load_keystream(cache->directory, cache->maxBytes, lfsr, get_samples_count(image)) : NULL;
+   int encrypted = keystream ? pnm_file_encryption_keystream(image, get_keystream_words(keystream), threadsCount)
+                             : pnm_file_encryption_parallel(image, lfsr, threadsCount);
+   if (keystream)
+   {
+      free_keystream(&keystream);
+   }
+   if (encrypted != 0)
+   {
+      free_pnm(&image);
+      fprintf(get_messages_stream(), "> 🔴 Unable to encrypt the file [%s].\n", input);
+      return 0;
+   }
+   if (stats)
+   {
+      end_stage(stats, STAGE_ENCRYPTION, &stamp);
+   }
+
+   // Step 3 : copy the file
+   if (write_pnm_indexed(image, output, threadsCount, indexStep) != 0)
+   {
+      free_pnm(&image);
+      fprintf(get_messages_stream(), "> 🔴 Unable to copy the file [%s] in [%s].\n", input, output);
+      return 0;
+   }
+   if (stats)
+   {
+      end_stage(stats, STAGE_WRITE, &stamp);
+      count_file(stats, input, output, get_samples_count(image));
+   }
+
+   free_pnm(&image);
+   return 1;
+} // end encrypt_file()
+
+/**
+ * \fn static void *batch_worker(void *batch)
+ * \brief Thread routine of the batch mode, encrypts the files of the batch until there is none left.
+ *
+ * \param batch The BATCH to process.
+ *
+ * \pre batch is instanced.
+ * \post The files taken by the worker are encrypted, or marked as failed.
+ *
+ * \return void* NULL.
+ */
+static void *batch_worker(void *batch)
+{
+   BATCH *files = batch;
+   while (1)
+   {
+      pthread_mutex_lock(&files->lock);
+      unsigned int i = files->next++;
+      pthread_mutex_unlock(&files->lock);
+      if (i >= files->count)
+      {
+         return NULL;
+      }
+
+      // every file is encrypted from the seed, with the worker's own copy of the lfsr, the workers already overlap the files
+      LFSR *lfsr = copy_lfsr(files->lfsr);
+      if (!lfsr)
+      {
+         fprintf(get_messages_stream(), "> 🔴 Unable to create the cipher tool for the file [%s].\n", files->inputs[i]);
+         files->failed[i] = 1;
+         continue;
+      }
+      files->failed[i] = !encrypt_file(files->inputs[i], files->outputs[i], lfsr, files->stream, 0, &files->cache, &files->crop, files->indexStep, 1, files->stats);
+      free_lfsr(&lfsr);
+   }
+} // end batch_worker()
+
+/**
+ * \fn static int read_manifest(char *manifest, BATCH *batch)
+ * \brief Add the files listed in a manifest to a batch.
+ *
+ * Each line of the manifest holds an input path and an output path separated by whitespace. The lines beginning
+ * with '#' are ignored.
+ *
+ * \param manifest The path to the manifest.
+ * \param batch The batch, its inputs and outputs are allocated by the function.
+ *
+ * \pre manifest is instanced, batch is instanced and empty.
+ * \post The files are in the batch, the paths have to be freed.
+ *
+ * \return int 0 Error (nothing to free)
+ *             1 Success
+ */
+static int read_manifest(char *manifest, BATCH *batch)
+{
+   FILE *file = fopen(manifest, "r");
+   if (!file)
+   {
+      fprintf(get_messages_stream(), "> 🔴 Unable to open the manifest [%s].\n", manifest);
+      return 0;
+   }
+
+   unsigned int capacity = 0;
+   char paths[2][MANIFEST_PATH_LEN];
+   int success = 1;
+   while (success && fscanf(file, " %4095s", paths[0]) == 1)
+   {
+      if (paths[0][0] == '#')
+      {
+         if (fscanf(file, "%*[^\n]") == EOF)
+         {
+            break;
+         }
+         continue;
+      }
+      if (fscanf(file, "%4095s", paths[1]) != 1)
+      {
+         fprintf(get_messages_stream(), "> 🔴 No output file for [%s] in the manifest [%s].\n", paths[0], manifest);
+         success = 0;
+         break;
+      }
+      if (is_standard_stream(paths[0]) || is_standard_stream(paths[1]))
+      {
+         fprintf(get_messages_stream(), "> 🔴 The standard streams (-) can only be used to encrypt a single file, not in the manifest [%s].\n", manifest);
+         success = 0;
+         break;
+      }
+
+      if (batch->count == capacity)
+      {
+         capacity = capacity ? 2 * capacity : 64;
+         char **inputs = realloc(batch->inputs, capacity * sizeof(char *));
+         if (inputs)
+         {
+            batch->inputs = inputs;
+         }
+         char **outputs = realloc(batch->outputs, capacity * sizeof(char *));
+         if (outputs)
+         {
+            batch->outputs = outputs;
+         }
+         if (!inputs || !outputs)
+         {
+            fprintf(get_messages_stream(), "> 🔴 Unable to allocate the memory space of the batch.\n");
+            success = 0;
+            break;
+         }
+      }
+      batch->inputs[batch->count] = malloc(strlen(paths[0]) + 1);
+      batch->outputs[batch->count] = malloc(strlen(paths[1]) + 1);
+      if (batch->inputs[batch->count] && batch->outputs[batch->count])
+      {
+         strcpy(batch->inputs[batch->count], paths[0]);
+         strcpy(batch->outputs[batch->count], paths[1]);
+         batch->count++;
+      }
+      else
+      {
+         fprintf(get_messages_stream(), "> 🔴 Unable to allocate the memory space of the batch.\n");
+         free(batch->inputs[batch->count]);
+         free(batch->outputs[batch->count]);
+         success = 0;
+      }
+   }
+   fclose(file);
+
+   if (!success)
+   {
+      for (unsigned int i = 0; i < batch->count; i++)
+      {
+         free(batch->inputs[i]);
+         free(batch->outputs[i]);
+      }
+      free(batch->inputs);
+      free(batch->outputs);
+      batch->inputs = batch->outputs = NULL;
+      batch->count = 0;
+   }
+   return success;
+} // end read_manifest()
+
+/**
+ * \fn static int run_batch(BATCH *batch, unsigned int workersCount)
+ * \brief Encrypt the files of a batch on a pool of workers and print a summary.
+ *
+ * \param batch The batch, its files and lfsr are set.
+ * \param workersCount The number of workers.
+ *
+ * \pre batch is instanced, workersCount > 0.
+ * \post The files are encrypted, the failures are listed in the summary.
+ *
+ * \return int 0 Error (a file at least wasn't encrypted)
+ *             1 Success
+ */
+static int run_batch(BATCH *batch, unsigned int workersCount)
+{
+   if (workersCount > batch->count)
+   {
+      workersCount = batch->count;
+   }
+   batch->next = 0;
+   batch->failed = calloc(batch->count ? batch->count : 1, sizeof(int));
+   pthread_t *workers = malloc((workersCount ? workersCount : 1) * sizeof(pthread_t));
+   if (!batch->failed || !workers || pthread_mutex_init(&batch->lock, NULL) != 0)
+   {
+      fprintf(get_messages_stream(), "> 🔴 Unable to allocate the memory space of the batch.\n");
+      free(batch->failed);
+      free(workers);
+      return 0;
+   }
+
+   // a worker that can't be started leaves its share to the others, the caller works if none could
+   unsigned int started = 0;
+   for (unsigned int w = 0; w < workersCount; w++)
+   {
+      if (pthread_create(&workers[started], NULL, batch_worker, batch) == 0)
+      {
+         started++;
+      }
+   }
+   if (started == 0)
+   {
+      batch_worker(batch);
+   }
+   for (unsigned int w = 0; w < started; w++)
+   {
+      pthread_join(workers[w], NULL);
+   }
+   pthread_mutex_destroy(&batch->lock);
+   free(workers);
+
+   unsigned int failures = 0;
+   for (unsigned int i = 0; i < batch->count; i++)
+   {
+      failures += batch->failed[i] != 0;
+   }
+   fprintf(get_messages_stream(), "> Batch summary : %u file(s), %u encrypted, %u failed.\n", batch->count, batch->count - failures, failures);
+   for (unsigned int i = 0; i < batch->count; i++)
+   {
+      if (batch->failed[i])
+      {
+         fprintf(get_messages_stream(), ">\t🔴 [%s] -> [%s]\n", batch->inputs[i], batch->outputs[i]);
+      }
+   }
+   free(batch->failed);
+   batch->failed = NULL;
+   return failures == 0;
+} // end run_batch()
 
 int main(int argc, char *argv[])
 {
    int val;
+   // the messages, on the standard error once the standard output carries an image
+   FILE *messages = stdout;
 
-   char *optstring = ":i:o:p:t:";
+   char *optstring = ":i:o:p:t:j:m:sq:c:C:";
+   struct option longOptions[] = {{"stats", no_argument, NULL, 'S'}, {"crop", required_argument, NULL, 'R'}, {"index", required_argument, NULL, 'X'}, {NULL, 0, NULL, 0}};
    char *input = "";
    char *output = "";
    char *seed = "";
    char *tap = "";
+   char *manifest = NULL;
 
    char *inputExtension = NULL;
    char *outputExtension = NULL;
    int tap_value = 0;
+   int threads_value = 1;
+   int stream = 0;
+   int queue_depth = DEFAULT_QUEUE_DEPTH;
+   CACHE cache = {NULL, (uint64_t)DEFAULT_CACHE_MEGABYTES << 20};
+   int cache_megabytes = DEFAULT_CACHE_MEGABYTES;
+   CROP crop = {0, 0, 0, 0, 0};
+   int index_step = 0;
+   int rectangle[4];
+   char trailing;
+   STATS statistics;
+   STATS *stats = NULL;
+   STAMP start;
 
-   while ((val = getopt(argc, argv, optstring)) != EOF)
+   // the -i / -o pairs, there are at most argc / 2 of them
+   char **inputs = malloc(argc * sizeof(char *));
+   char **outputs = malloc(argc * sizeof(char *));
+   unsigned int inputsCount = 0;
+   unsigned int outputsCount = 0;
+   if (!inputs || !outputs)
+   {
+      fprintf(messages, "> 🔴 Unable to allocate the memory space of the arguments.\n");
+      free(inputs);
+      free(outputs);
+      return EXIT_FAILURE;
+   }
+
+   while ((val = getopt_long(argc, argv, optstring, longOptions, NULL)) != EOF)
    {
       switch (val)
       {
       case 'i':
          input = optarg;
-         if (!(inputExtension = get_file_extension(input)))
+         inputExtension = NULL;
+         if (!is_standard_stream(input) && !(inputExtension = get_file_extension(input)))
          {
-            printf("> 🔴 Argument -i invalid.\n");
-            return 0;
+            fprintf(messages, "> 🔴 Argument -i invalid.\n");
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
          }
+         inputs[inputsCount++] = input;
          break;
 
       case 'o':
          output = optarg;
-         if (!(outputExtension = get_file_extension(output)))
+         outputExtension = NULL;
+         if (!is_standard_stream(output) && !(outputExtension = get_file_extension(output)))
          {
-            printf("> 🔴 Argument -o invalid.\n");
-            return 0;
+            fprintf(messages, "> 🔴 Argument -o invalid.\n");
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
          }
-         if (strcmp(inputExtension, outputExtension))
+         if (outputsCount + 1 != inputsCount || (inputExtension && outputExtension && strcmp(inputExtension, outputExtension)))
          {
-            printf("> 🔴 The input file [%s] and the output file [%s] do not agree on the image format.\n", inputExtension, output);
-            return 0;
+            fprintf(messages, "> 🔴 The input file [%s] and the output file [%s] do not agree on the image format.\n", input, output);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
          }
+         outputs[outputsCount++] = output;
+         break;
+
+      case 'm':
+         manifest = optarg;
          break;
 
       case 'p':
@@ -67,65 +688,230 @@ int main(int argc, char *argv[])
          tap = optarg;
          if (sscanf(tap, "%d", &tap_value) != 1)
          {
-            printf("> 🔴 No numeric value in the tap [%s].\n", optarg);
-            return 0;
+            fprintf(messages, "> 🔴 No numeric value in the tap [%s].\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
          }
          if (tap_value < 0)
          {
-            printf("> 🔴 The numeric value in the tap [%s] is too small. It should be >= 0.\n", optarg);
-            return 0;
+            fprintf(messages, "> 🔴 The numeric value in the tap [%s] is too small. It should be >= 0.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         break;
+
+      case 'j':
+         if (sscanf(optarg, "%d", &threads_value) != 1)
+         {
+            fprintf(messages, "> 🔴 No numeric value in the number of threads [%s].\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         if (threads_value < 1)
+         {
+            fprintf(messages, "> 🔴 The number of threads [%s] is too small. It should be >= 1.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         break;
+
+      case 's':
+         stream = 1;
+         break;
+
+      case 'q':
+         if (sscanf(optarg, "%d", &queue_depth) != 1 || queue_depth < 0)
+         {
+            fprintf(messages, "> 🔴 The depth of the streaming queues [%s] should be a number >= 0.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         break;
+
+      case 'c':
+         cache.directory = optarg;
+         break;
+
+      case 'C':
+         if (sscanf(optarg, "%d", &cache_megabytes) != 1 || cache_megabytes < 1)
+         {
+            fprintf(messages, "> 🔴 The size of the keystream cache [%s] should be a number of megabytes >= 1.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         cache.maxBytes = (uint64_t)cache_megabytes << 20;
+         break;
+
+      case 'S':
+         stats = &statistics;
+         break;
+
+      case 'R':
+         if (sscanf(optarg, "%d,%d,%d,%d%c", &rectangle[0], &rectangle[1], &rectangle[2], &rectangle[3], &trailing) != 4 ||
+             rectangle[0] < 0 || rectangle[1] < 0 || rectangle[2] < 1 || rectangle[3] < 1)
+         {
+            fprintf(messages, "> 🔴 The rectangle [%s] should be x,y,width,height with x, y >= 0 and width, height >= 1.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
+         }
+         crop.enabled = 1;
+         crop.x = (unsigned int)rectangle[0];
+         crop.y = (unsigned int)rectangle[1];
+         crop.width = (unsigned int)rectangle[2];
+         crop.height = (unsigned int)rectangle[3];
+         break;
+
+      case 'X':
+         if (sscanf(optarg, "%d%c", &index_step, &trailing) != 1 || index_step < 1)
+         {
+            fprintf(messages, "> 🔴 The step of the row index [%s] should be a number of lines >= 1.\n", optarg);
+            free(inputs);
+            free(outputs);
+            return EXIT_FAILURE;
          }
          break;
 
       case ':':
-         printf("> 🔴 Argument missing for -%c.\n", optopt);
-         return 0;
+         fprintf(messages, "> 🔴 Argument missing for -%c.\n", optopt);
+         free(inputs);
+         free(outputs);
+         return EXIT_FAILURE;
 
       case '?':
-         printf("> 🔴 Option -%c unknow.\n", optopt);
-         return 0;
+         fprintf(messages, "> 🔴 Option -%c unknow.\n", optopt);
+         free(inputs);
+         free(outputs);
+         return EXIT_FAILURE;
       }
    } // end args loop
 
    // check that arguments aren't empty
-   if (strlen(input) == 0 || strlen(output) == 0 || strlen(seed) == 0 || strlen(tap) == 0)
+   if ((!manifest && inputsCount == 0) || inputsCount != outputsCount || strlen(seed) == 0 || strlen(tap) == 0)
    {
-      printf("> 🔴 This kind of command is not likely to work.\n");
-      printf(">\tHere's how to use the program :\n");
-      printf(">\t./advanced_cipher -i inputFilePath -o outputFileName -p passwordValue -t tapValue\n");
-      return 0;
+      fprintf(messages, "> 🔴 This kind of command is not likely to work.\n");
+      fprintf(messages, ">\tHere's how to use the program :\n");
+      fprintf(messages, ">\t./advanced_cipher -i inputFilePath|- -o outputFileName|- [-i inputFilePath -o outputFileName ...] [-m manifestPath] -p passwordValue -t tapValue [-j threadsCount] [-s [-q queueDepth]] [-c cacheDirectory [-C cacheMegabytes]] [--crop x,y,width,height] [--index step] [--stats]\n");
+      free(inputs);
+      free(outputs);
+      return EXIT_FAILURE;
    }
 
-   // Step 1 : file processing
-   PNM *image;
-   if (load_pnm(&image, input) != 0)
+   // a standard stream holds a single image, the messages leave the standard output to the encrypted one
+   for (unsigned int i = 0; i < inputsCount; i++)
    {
-      printf("> 🔴 Unable to load the file [%s].\n", input);
-      return 0;
+      if ((is_standard_stream(inputs[i]) || is_standard_stream(outputs[i])) && (manifest || inputsCount > 1))
+      {
+         fprintf(messages, "> 🔴 The standard streams (-) can only be used to encrypt a single file.\n");
+         free(inputs);
+         free(outputs);
+         return EXIT_FAILURE;
+      }
+      if (is_standard_stream(outputs[i]))
+      {
+         messages = stderr;
+         set_messages_stream(messages);
+      }
+   }
+
+   // the measures start with the cipher tool, the workers of a batch measure their own cpu time
+   if (stats)
+   {
+      memset(stats, 0, sizeof(STATS));
+      stats->cpuClock = !manifest && inputsCount == 1 ? CLOCK_PROCESS_CPUTIME_ID : CLOCK_THREAD_CPUTIME_ID;
+      if (pthread_mutex_init(&stats->lock, NULL) != 0)
+      {
+         fprintf(messages, "> 🔴 Unable to prepare the statistics.\n");
+         free(inputs);
+         free(outputs);
+         return EXIT_FAILURE;
+      }
+      countAllocations = 1;
+      start = stamp_now(CLOCK_PROCESS_CPUTIME_ID);
    }
 
-   // Step 2 : encryption of the file
    char *seedConverted = base64_string_to_binary_string(seed);
    LFSR *lfsr = create_lfsr(seedConverted, tap_value);
    free(seedConverted);
    if (!lfsr)
    {
-      free_pnm(&image);
-      printf("> 🔴 Unable to create the cipher tool.\n");
-      return 0;
+      fprintf(messages, "> 🔴 Unable to create the cipher tool.\n");
+      free(inputs);
+      free(outputs);
+      return EXIT_FAILURE;
    }
-   pnm_file_encryption(image, lfsr);
 
-   // Step 3 : copy the file
-   if (write_pnm(image, output) != 0)
+   // a single file : its encryption uses all the threads
+   if (!manifest && inputsCount == 1)
    {
-      free_pnm(&image);
+      int encrypted = encrypt_file(inputs[0], outputs[0], lfsr, stream, (unsigned int)queue_depth, &cache, &crop, (unsigned int)index_step, (unsigned int)threads_value, stats);
       free_lfsr(&lfsr);
-      printf("> 🔴 Unable to copy the file [%s] in [%s].\n", input, output);
-      return 0;
+      free(inputs);
+      free(outputs);
+      if (stats)
+      {
+         print_stats(stats, &start);
+         pthread_mutex_destroy(&stats->lock);
+      }
+      return encrypted ? EXIT_SUCCESS : EXIT_FAILURE;
    }
 
+   // a batch : each thread is a worker encrypting whole files
+   BATCH batch;
+   memset(&batch, 0, sizeof(BATCH));
+   batch.lfsr = lfsr;
+   batch.stream = stream;
+   batch.cache = cache;
+   batch.crop = crop;
+   batch.indexStep = (unsigned int)index_step;
+   batch.stats = stats;
+   if (manifest && !read_manifest(manifest, &batch))
+   {
+      free_lfsr(&lfsr);
+      free(inputs);
+      free(outputs);
+      return EXIT_FAILURE;
+   }
+   unsigned int manifestCount = batch.count;
+   int encrypted = 0;
+   char **allInputs = realloc(batch.inputs, (manifestCount + inputsCount + 1) * sizeof(char *));
+   char **allOutputs = allInputs ? realloc(batch.outputs, (manifestCount + inputsCount + 1) * sizeof(char *)) : NULL;
+   if (allInputs && allOutputs)
+   {
+      memcpy(allInputs + manifestCount, inputs, inputsCount * sizeof(char *));
+      memcpy(allOutputs + manifestCount, outputs, inputsCount * sizeof(char *));
+      batch.inputs = allInputs;
+      batch.outputs = allOutputs;
+      batch.count = manifestCount + inputsCount;
+      encrypted = run_batch(&batch, (unsigned int)threads_value);
+   }
+   else
+   {
+      fprintf(messages, "> 🔴 Unable to allocate the memory space of the batch.\n");
+      batch.inputs = allInputs ? allInputs : batch.inputs;
+   }
+
+   // only the paths read from the manifest were allocated
+   for (unsigned int i = 0; i < manifestCount; i++)
+   {
+      free(batch.inputs[i]);
+      free(batch.outputs[i]);
+   }
+   free(batch.inputs);
+   free(batch.outputs);
    free_lfsr(&lfsr);
-   free_pnm(&image);
-   return 0;
+   free(inputs);
+   free(outputs);
+   if (stats)
+   {
+      print_stats(stats, &start);
+      pthread_mutex_destroy(&stats->lock);
+   }
+   return encrypted ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,302 @@
+/**
+ * \file keystream_tests.c
+ * \brief This file contains tests for the keystream cache library.
+ * \author Gardier Simon
+ * \date 26.10.2023
+ * \version: V2
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "../seatest/seatest.h"
+#include "../keystream/keystream.h"
+
+char *cacheDirectory = "keystream_tests_cache"; /*!< The cache directory used by the tests, removed afterwards.*/
+
+/**
+ * \fn static void test_load_keystream()
+ * @brief Test load_keystream() for :
+ *      - A miss, compared with lfsr_fill()
+ *      - A hit on a longer entry
+ *      - A partial hit extending the entry
+ */
+static void test_load_keystream(void);
+
+/**
+ * \fn static void test_eviction()
+ * @brief Test that the least recently used entry is removed when the cache is full
+ */
+static void test_eviction(void);
+
+/**
+ * \fn static void test_entry_privacy()
+ * @brief Test that the cache directory and its entries are readable by their owner only, and that an entry doesn't
+ *        hold the register
+ */
+static void test_entry_privacy(void);
+
+/**
+ * \fn static void test_byte_order()
+ * @brief Test that an entry written on a machine of another byte order is a miss, the entry being written again
+ */
+static void test_byte_order(void);
+
+/**
+ * \fn static void test_fixture()
+ * @brief Run the test routine
+ */
+static void test_fixture(void);
+
+/**
+ * \fn static void all_tests()
+ * @brief Run all the tests
+ */
+static void all_tests(void);
+
+/**
+ * \fn static unsigned int list_entries(char *first)
+ * @brief Count the files of the cache directory
+ *
+ * \param first The address where to copy the name of the first file found (64 characters), NULL if not needed.
+ *
+ * \return unsigned int The number of files.
+ */
+static unsigned int list_entries(char *first)
+{
+  unsigned int count = 0;
+  DIR *folder = opendir(cacheDirectory);
+  struct dirent *file;
+  while (folder && (file = readdir(folder)))
+  {
+    if (file->d_name[0] != '.')
+    {
+      if (first && count == 0)
+      {
+        strncpy(first, file->d_name, 63);
+        first[63] = '\0';
+      }
+      count++;
+    }
+  }
+  if (folder)
+  {
+    closedir(folder);
+  }
+  return count;
+} // end list_entries()
+
+/**
+ * \fn static void remove_cache()
+ * @brief Remove the cache directory and its files
+ */
+static void remove_cache(void)
+{
+  DIR *folder = opendir(cacheDirectory);
+  struct dirent *file;
+  char path[512];
+  while (folder && (file = readdir(folder)))
+  {
+    if (strcmp(file->d_name, ".") && strcmp(file->d_name, ".."))
+    {
+      snprintf(path, sizeof(path), "%s/%s", cacheDirectory, file->d_name);
+      unlink(path);
+    }
+  }
+  if (folder)
+  {
+    closedir(folder);
+  }
+  rmdir(cacheDirectory);
+} // end remove_cache()
+
+/**
+ * \fn static int same_words(const uint32_t *words, char *seed, int tap, size_t count)
+ * @brief Compare words with the keystream generated by lfsr_fill()
+ *
+ * \return int 1 if the words are the keystream, 0 otherwise
+ */
+static int same_words(const uint32_t *words, char *seed, int tap, size_t count)
+{
+  LFSR *lfsr = create_lfsr(seed, tap);
+  uint32_t *expected = malloc(count * sizeof(uint32_t));
+  lfsr_fill(lfsr, expected, count);
+  int same = memcmp(words, expected, count * sizeof(uint32_t)) == 0;
+  free(expected);
+  free_lfsr(&lfsr);
+  return same;
+} // end same_words()
+
+static void test_load_keystream(void)
+{
+  char *seed = "0110100001011101";
+  LFSR *lfsr = create_lfsr(seed, 5);
+  remove_cache();
+
+  KEYSTREAM *keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 100);
+  assert_true(keystream != NULL);
+  assert_true(same_words(get_keystream_words(keystream), seed, 5, 100));
+  assert_int_equal(1, list_entries(NULL));
+  free_keystream(&keystream);
+  assert_true(keystream == NULL);
+
+  char *state = to_string(lfsr);
+  assert_string_equal(seed, state);
+  free(state);
+
+  keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 5000);
+  assert_true(same_words(get_keystream_words(keystream), seed, 5, 5000));
+  free_keystream(&keystream);
+
+  keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 50);
+  assert_true(same_words(get_keystream_words(keystream), seed, 5, 50));
+  free_keystream(&keystream);
+  assert_int_equal(1, list_entries(NULL));
+  free_lfsr(&lfsr);
+
+  // another tap is another entry
+  lfsr = create_lfsr(seed, 6);
+  keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 100);
+  assert_true(same_words(get_keystream_words(keystream), seed, 6, 100));
+  free_keystream(&keystream);
+  assert_int_equal(2, list_entries(NULL));
+  free_lfsr(&lfsr);
+
+  remove_cache();
+} // end test_load_keystream()
+
+static void test_eviction(void)
+{
+  char *seeds[3] = {"0110100001011101", "1110100001011101", "0010100001011101"};
+  struct timespec pause = {0, 20000000};
+  char oldest[64];
+  char survivor[64];
+  remove_cache();
+
+  // an entry of 1000 words takes a bit more than 4000 bytes, the cache can hold two of them
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    LFSR *lfsr = create_lfsr(seeds[i], 5);
+    KEYSTREAM *keystream = load_keystream(cacheDirectory, 9000, lfsr, 1000);
+    assert_true(keystream != NULL);
+    free_keystream(&keystream);
+    free_lfsr(&lfsr);
+    if (i == 0)
+    {
+      list_entries(oldest);
+    }
+    nanosleep(&pause, NULL);
+  }
+  assert_int_equal(2, list_entries(NULL));
+
+  // the oldest entry was evicted : using it again creates it and evicts the second one
+  LFSR *lfsr = create_lfsr(seeds[0], 5);
+  KEYSTREAM *keystream = load_keystream(cacheDirectory, 4500, lfsr, 1000);
+  assert_true(same_words(get_keystream_words(keystream), seeds[0], 5, 1000));
+  free_keystream(&keystream);
+  free_lfsr(&lfsr);
+  assert_int_equal(1, list_entries(survivor));
+  assert_string_equal(oldest, survivor);
+
+  remove_cache();
+} // end test_eviction()
+
+static void test_entry_privacy(void)
+{
+  char *seed = "0110100001011101";
+  char name[64];
+  char path[512];
+  struct stat fileStatus;
+  remove_cache();
+
+  LFSR *lfsr = create_lfsr(seed, 5);
+  KEYSTREAM *keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 100);
+  assert_true(keystream != NULL);
+  free_keystream(&keystream);
+  free_lfsr(&lfsr);
+
+  assert_int_equal(0, stat(cacheDirectory, &fileStatus));
+  assert_int_equal(0, fileStatus.st_mode & 077);
+  assert_int_equal(1, list_entries(name));
+  snprintf(path, sizeof(path), "%s/%s", cacheDirectory, name);
+  assert_int_equal(0, stat(path, &fileStatus));
+  assert_int_equal(0, fileStatus.st_mode & 077);
+
+  FILE *entry = fopen(path, "rb");
+  char *content = malloc((size_t)fileStatus.st_size + 1);
+  assert_int_equal(fileStatus.st_size, (long)fread(content, 1, (size_t)fileStatus.st_size, entry));
+  content[fileStatus.st_size] = '\0';
+  fclose(entry);
+  int found = 0;
+  for (long i = 0; i + (long)strlen(seed) <= fileStatus.st_size; i++)
+  {
+    found = found || memcmp(content + i, seed, strlen(seed)) == 0;
+  }
+  assert_true(!found);
+  free(content);
+
+  remove_cache();
+} // end test_entry_privacy()
+
+static void test_byte_order(void)
+{
+  char *seed = "0110100001011101";
+  char name[64];
+  char path[512];
+  unsigned char mark[4];
+  remove_cache();
+
+  LFSR *lfsr = create_lfsr(seed, 5);
+  KEYSTREAM *keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 100);
+  free_keystream(&keystream);
+  assert_int_equal(1, list_entries(name));
+  snprintf(path, sizeof(path), "%s/%s", cacheDirectory, name);
+
+  // the byte order mark follows the 8 bytes of the magic, reversed it reads as the mark of the other byte order
+  FILE *entry = fopen(path, "r+b");
+  fseek(entry, 8, SEEK_SET);
+  assert_int_equal(4, (int)fread(mark, 1, 4, entry));
+  unsigned char reversed[4] = {mark[3], mark[2], mark[1], mark[0]};
+  fseek(entry, 8, SEEK_SET);
+  fwrite(reversed, 1, 4, entry);
+  fclose(entry);
+
+  keystream = load_keystream(cacheDirectory, 1 << 20, lfsr, 100);
+  assert_true(keystream != NULL);
+  assert_true(same_words(get_keystream_words(keystream), seed, 5, 100));
+  free_keystream(&keystream);
+  entry = fopen(path, "rb");
+  fseek(entry, 8, SEEK_SET);
+  assert_int_equal(4, (int)fread(reversed, 1, 4, entry));
+  fclose(entry);
+  assert_true(memcmp(mark, reversed, 4) == 0);
+  free_lfsr(&lfsr);
+
+  remove_cache();
+} // end test_byte_order()
+
+static void test_fixture(void)
+{
+  test_fixture_start();
+  run_test(test_load_keystream);
+  run_test(test_eviction);
+  run_test(test_entry_privacy);
+  run_test(test_byte_order);
+  test_fixture_end();
+} // end test_fixture()
+
+static void all_tests(void)
+{
+  test_fixture();
+} // end all_tests()
+
+int main(void)
+{
+  return run_tests(all_tests);
+} // end main()
@@ -32,6 +32,12 @@ static void test_create_lfsr(void);
  */
 static void test_operation(void);
 
+/**
+ * \fn static void test_operation_long_register()
+ * @brief Test test_operation() against a naive one int per bit register, for a register spanning several words
+ */
+static void test_operation_long_register(void);
+
 /**
  * \fn static void test_generation()
  * @brief Test test_generation() for :
@@ -41,6 +47,20 @@ static void test_operation(void);
  */
 static void test_generation(void);
 
+/**
+ * \fn static void test_lfsr_fill()
+ * @brief Test lfsr_fill() against successive generation(lfsr, 32) calls
+ */
+static void test_lfsr_fill(void);
+
+/**
+ * \fn static void test_lfsr_jump()
+ * @brief Test lfsr_jump() for :
+ *      - Random seeds, taps and offsets compared with naive stepping
+ *      - Two jumps compared with a single jump of the sum of the offsets
+ */
+static void test_lfsr_jump(void);
+
 /**
  *
  * \fn static void test_get_register()
@@ -61,6 +81,32 @@ static void test_get_tap(void);
  */
 static void test_to_string(void);
 
+/**
+ * \fn static void test_chunk_engine()
+ * @brief Test that lfsr_fill(), generation() and lfsr_jump() give the results of operation() whatever the engine
+ *        chosen for the register (bit, 8 bits or 16 bits chunks), for random lengths and taps
+ */
+static void test_chunk_engine(void);
+
+/**
+ * \fn static void test_galois()
+ * @brief Test that the Galois register created from a lfsr gives its results, for random lengths and taps
+ */
+static void test_galois(void);
+
+/**
+ * \fn static void test_ring()
+ * @brief Test that the ring register created from a lfsr gives its results and its register in the same order,
+ *        the head wrapping around the buffer several times
+ */
+static void test_ring(void);
+
+/**
+ * \fn static void test_get_steps()
+ * @brief Test get_steps() and get_freed_steps() after operation(), generation(), lfsr_fill(), lfsr_jump() and copy_lfsr()
+ */
+static void test_get_steps(void);
+
 /**
  * \fn static void test_free_pnm()
  * @brief Test test_free_pnm() in a basic case
@@ -109,6 +155,31 @@ static void test_operation(void)
     free_lfsr(&lfsr);
 } // end test_operation
 
+static void test_operation_long_register(void)
+{
+    char longSeed[151];
+    unsigned int naiveReg[150];
+    unsigned int longTap = 97;
+    srand(42);
+    for (unsigned int i = 0; i < 150; i++)
+    {
+        naiveReg[i] = rand() % 2;
+        longSeed[i] = (char)naiveReg[i] + '0';
+    }
+    longSeed[150] = '\0';
+
+    LFSR *lfsr = create_lfsr(longSeed, longTap);
+    for (unsigned int k = 0; k < 1000; k++)
+    {
+        unsigned int expected = naiveReg[0] ^ naiveReg[150 - longTap - 1];
+        memmove(naiveReg, naiveReg + 1, 149 * sizeof(unsigned int));
+        naiveReg[149] = expected;
+        assert_int_equal(expected, operation(lfsr));
+    }
+    assert_n_array_equal(naiveReg, get_register(lfsr), 150);
+    free_lfsr(&lfsr);
+} // end test_operation_long_register()
+
 static void test_generation(void)
 {
     unsigned int expectedRegAfterOperation[11] = {0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 1};
@@ -124,6 +195,193 @@ static void test_generation(void)
     free_lfsr(&lfsr);
 } // end test_operation()
 
+static void test_lfsr_fill(void)
+{
+    uint32_t keystream[100];
+    LFSR *filled = create_lfsr(seed, tap);
+    LFSR *generated = create_lfsr(seed, tap);
+
+    lfsr_fill(filled, keystream, 100);
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        assert_true(keystream[i] == generation(generated, 32));
+    }
+    assert_n_array_equal(get_register(generated), get_register(filled), 11);
+
+    free_lfsr(&filled);
+    free_lfsr(&generated);
+} // end test_lfsr_fill()
+
+static void test_lfsr_jump(void)
+{
+    char randomSeed[201];
+    srand(1947);
+    for (unsigned int round = 0; round < 40; round++)
+    {
+        unsigned int length = 1 + rand() % 200;
+        for (unsigned int i = 0; i < length; i++)
+        {
+            randomSeed[i] = (char)(rand() % 2) + '0';
+        }
+        randomSeed[length] = '\0';
+        int randomTap = rand() % length;
+        uint64_t offset = (uint64_t)(rand() % 50000);
+
+        LFSR *jumped = create_lfsr(randomSeed, randomTap);
+        LFSR *stepped = create_lfsr(randomSeed, randomTap);
+        assert_int_equal(0, lfsr_jump(jumped, offset));
+        for (uint64_t i = 0; i < offset; i++)
+        {
+            operation(stepped);
+        }
+        assert_n_array_equal(get_register(stepped), get_register(jumped), (int)length);
+        assert_true(generation(jumped, 32) == generation(stepped, 32));
+        free_lfsr(&jumped);
+        free_lfsr(&stepped);
+    }
+
+    LFSR *twice = create_lfsr("0110100001011101011101110001", 11);
+    LFSR *once = create_lfsr("0110100001011101011101110001", 11);
+    assert_int_equal(0, lfsr_jump(twice, 123456789012ULL));
+    assert_int_equal(0, lfsr_jump(twice, 987654321098ULL));
+    assert_int_equal(0, lfsr_jump(once, 123456789012ULL + 987654321098ULL));
+    assert_n_array_equal(get_register(once), get_register(twice), 28);
+    free_lfsr(&twice);
+    free_lfsr(&once);
+} // end test_lfsr_jump()
+
+static void test_chunk_engine(void)
+{
+    char randomSeed[601];
+    uint32_t words[8];
+    unsigned int lengths[] = {1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 128, 129, 600};
+    srand(2023);
+    for (unsigned int round = 0; round < 80; round++)
+    {
+        unsigned int length = round < 16 ? lengths[round] : 1 + (unsigned int)(rand() % 600);
+        for (unsigned int i = 0; i < length; i++)
+        {
+            randomSeed[i] = (char)(rand() % 2) + '0';
+        }
+        randomSeed[length] = '\0';
+        int randomTap = round % 3 == 0 ? rand() % (length < 16 ? length : 16) : rand() % length;
+
+        LFSR *chunked = create_lfsr(randomSeed, randomTap);
+        LFSR *stepped = create_lfsr(randomSeed, randomTap);
+        lfsr_fill(chunked, words, 8);
+        unsigned int mixed = generation(chunked, 21);
+        assert_int_equal(0, lfsr_jump(chunked, 37));
+        for (unsigned int i = 0; i < 8; i++)
+        {
+            uint32_t expected = 0;
+            for (unsigned int k = 0; k < 32; k++)
+            {
+                expected = (expected << 1) | operation(stepped);
+            }
+            assert_true(words[i] == expected);
+        }
+        unsigned int expectedMixed = 0;
+        for (unsigned int k = 0; k < 21; k++)
+        {
+            expectedMixed = expectedMixed * 2 + operation(stepped);
+        }
+        assert_true(mixed == expectedMixed);
+        for (unsigned int k = 0; k < 37; k++)
+        {
+            operation(stepped);
+        }
+        assert_n_array_equal(get_register(stepped), get_register(chunked), (int)length);
+
+        // a copy shares the table and outlives the original
+        LFSR *copy = copy_lfsr(chunked);
+        free_lfsr(&chunked);
+        assert_true(generation(copy, 32) == generation(stepped, 32));
+        free_lfsr(&copy);
+        free_lfsr(&stepped);
+    }
+} // end test_chunk_engine()
+
+static void test_galois(void)
+{
+    char randomSeed[601];
+    uint32_t words[16];
+    uint32_t galoisWords[16];
+    srand(1234);
+    for (unsigned int round = 0; round < 60; round++)
+    {
+        unsigned int length = round < 10 ? 1 + round : 1 + (unsigned int)(rand() % 600);
+        for (unsigned int i = 0; i < length; i++)
+        {
+            randomSeed[i] = (char)(rand() % 2) + '0';
+        }
+        randomSeed[length] = '\0';
+        int randomTap = round % 4 == 0 ? (int)length - 1 : rand() % (int)length;
+
+        // the conversion works from any state of the lfsr
+        LFSR *lfsr = create_lfsr(randomSeed, randomTap);
+        generation(lfsr, round);
+        GALOIS_LFSR *galois = create_galois_lfsr(lfsr);
+        assert_true(galois != NULL);
+
+        for (unsigned int k = 0; k < 40; k++)
+        {
+            assert_int_equal(operation(lfsr), galois_operation(galois));
+        }
+        lfsr_fill(lfsr, words, 16);
+        galois_fill(galois, galoisWords, 16);
+        assert_true(memcmp(words, galoisWords, sizeof(words)) == 0);
+
+        free_galois_lfsr(&galois);
+        assert_true(galois == NULL);
+        free_lfsr(&lfsr);
+    }
+} // end test_galois()
+
+static void test_ring(void)
+{
+    char randomSeed[601];
+    uint32_t words[16];
+    uint32_t ringWords[16];
+    srand(4321);
+    for (unsigned int round = 0; round < 60; round++)
+    {
+        unsigned int length = round < 10 ? 1 + round : 1 + (unsigned int)(rand() % 600);
+        for (unsigned int i = 0; i < length; i++)
+        {
+            randomSeed[i] = (char)(rand() % 2) + '0';
+        }
+        randomSeed[length] = '\0';
+        int randomTap = round % 4 == 0 ? (int)length - 1 : rand() % (int)length;
+
+        LFSR *lfsr = create_lfsr(randomSeed, randomTap);
+        generation(lfsr, round);
+        RING_LFSR *ring = create_ring_lfsr(lfsr);
+        assert_true(ring != NULL);
+
+        // the head goes around the buffer at least twice, the registers agree at every position of the head
+        for (unsigned int k = 0; k < 2 * length + 3; k++)
+        {
+            assert_int_equal(operation(lfsr), ring_operation(ring));
+            assert_true(memcmp(get_register(lfsr), ring_get_register(ring), length * sizeof(unsigned int)) == 0);
+        }
+        char *expected = to_string(lfsr);
+        char *result = ring_to_string(ring);
+        assert_string_equal(expected, result);
+        free(expected);
+        free(result);
+
+        // and the fill wraps around in the middle of the words
+        lfsr_fill(lfsr, words, 16);
+        ring_fill(ring, ringWords, 16);
+        assert_true(memcmp(words, ringWords, sizeof(words)) == 0);
+        assert_true(memcmp(get_register(lfsr), ring_get_register(ring), length * sizeof(unsigned int)) == 0);
+
+        free_ring_lfsr(&ring);
+        assert_true(ring == NULL);
+        free_lfsr(&lfsr);
+    }
+} // end test_ring()
+
 static void test_get_register(void)
 {
     LFSR *lfsr;
@@ -155,6 +413,32 @@ static void test_to_string(void)
     free_lfsr(&lfsr);
 } // end test_to_string()
 
+static void test_get_steps(void)
+{
+    uint32_t words[3];
+    LFSR *lfsr = create_lfsr(seed, tap);
+    uint64_t freed = get_freed_steps();
+
+    operation(lfsr);
+    generation(lfsr, 5);
+    lfsr_fill(lfsr, words, 3);
+    assert_true(get_steps(lfsr) == 102);
+
+    // the operations skipped by a short (walked) or a long (computed) jump aren't counted
+    assert_true(lfsr_jump(lfsr, 5) == 0);
+    assert_true(get_steps(lfsr) == 102);
+    assert_true(lfsr_jump(lfsr, 1000) == 0);
+    assert_true(get_steps(lfsr) == 102);
+
+    LFSR *copy = copy_lfsr(lfsr);
+    assert_true(get_steps(copy) == 0);
+    generation(copy, 10);
+    free_lfsr(&copy);
+    assert_true(get_freed_steps() == freed + 10);
+    free_lfsr(&lfsr);
+    assert_true(get_freed_steps() == freed + 112);
+} // end test_get_steps()
+
 static void test_free_pnm(void)
 {
     LFSR *lfsr;
@@ -171,7 +455,14 @@ static void test_fixture(void)
     run_test(test_get_tap);
     run_test(test_to_string);
     run_test(test_operation);
+    run_test(test_operation_long_register);
     run_test(test_generation);
+    run_test(test_lfsr_fill);
+    run_test(test_lfsr_jump);
+    run_test(test_chunk_engine);
+    run_test(test_galois);
+    run_test(test_ring);
+    run_test(test_get_steps);
     run_test(test_free_pnm);
     test_fixture_end();
 } // end test_fixture()
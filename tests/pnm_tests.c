@@ -6,6 +6,15 @@
  * \version: V2
  */
 
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
 #include "../seatest/seatest.h"
 #include "../pnm/pnm.h"
 #include "../lfsr/lfsr.h"
@@ -19,17 +28,92 @@
  *      - File with missing pixels
  *      - File with a correct structure
  *      - File with a correct structure and comment bt two lines of the pixels matrix
+ *      - File with a correct structure and comment at the end of a line of the pixels matrix
+ *      - File read from the standard input, its format given by the magic number
  */
 static void test_load_pnm(void);
 
+/**
+ * \fn static void test_load_pnm_parallel()
+ * @brief Test that load_pnm_parallel() loads the same samples as load_pnm() for several numbers of threads, on a large
+ *        image with comments between and at the end of the lines of the matrix and a sample wider than its header,
+ *        and that missing pixels are still an error
+ */
+static void test_load_pnm_parallel(void);
+
 /**
  * \fn static void test_write_pnm()
  * @brief Test test_write_pnm() for :
  *      - File from another directory
  *      - File from the current (wich is the good) directory
+ *      - Standard output on a full device
  */
 static void test_write_pnm(void);
 
+/**
+ * \fn static void test_write_pnm_parallel()
+ * @brief Test that write_pnm_parallel() writes the same file as write_pnm() for several numbers of threads, with bits,
+ *        bytes and 16 bits samples, in ASCII and in binary, and that a block that can't be written is an error
+ */
+static void test_write_pnm_parallel(void);
+
+/**
+ * \fn static void test_get_sample()
+ * @brief Test get_sample() on the first and the last line of an image
+ */
+static void test_get_sample(void);
+
+/**
+ * \fn static void test_encryption_round_trip()
+ * @brief Test that a P1 image (bits) goes back to its samples after an encryption (16 bits samples), a write, a load and a decryption
+ */
+static void test_encryption_round_trip(void);
+
+/**
+ * \fn static void test_binary_pnm()
+ * @brief Test the binary formats for :
+ *      - P4 (bits), P5 (8 bits samples) and P6 (16 bits big-endian samples) loading
+ *      - A load and a write giving back the same file
+ *      - An encryption keeping the layout, and a decryption giving back the same file
+ */
+static void test_binary_pnm(void);
+
+/**
+ * \fn static void test_pnm_file_encryption_parallel()
+ * @brief Test pnm_file_encryption_parallel() against pnm_file_encryption() for several numbers of threads
+ */
+static void test_pnm_file_encryption_parallel(void);
+
+/**
+ * \fn static void test_pnm_file_encryption_stream()
+ * @brief Test that the streaming encryption gives the same images and lfsr state as the encryption of a loaded image,
+ *        and that a standard output where every write fails is an error
+ */
+static void test_pnm_file_encryption_stream(void);
+
+/**
+ * \fn static void test_pnm_file_encryption_pipeline()
+ * @brief Test that pnm_file_encryption_stream() writes the same file whatever the depth of its pipeline, on an image
+ *        of many bands, and that a truncated image is an error at every depth
+ */
+static void test_pnm_file_encryption_pipeline(void);
+
+/**
+ * \fn static void test_pnm_file_crop()
+ * @brief Test that pnm_file_crop() on an encrypted image gives the samples of the original image inside the rectangle,
+ *        in ASCII and in binary, and that a rectangle outside the image is an error
+ */
+static void test_pnm_file_crop(void);
+
+/**
+ * \fn static void test_load_pnm_rows()
+ * @brief Test that load_pnm_rows() loads the lines of the range, with and without the row index written by
+ *        write_pnm_indexed(), that the index lets it skip lines it can't parse, that a stale index is ignored or
+ *        removed, that an index of another image of the same size is ignored, and that a range outside the image is an
+ *        error
+ */
+static void test_load_pnm_rows(void);
+
 /**
  * \fn static void test_free_pnm()
  * @brief Test test_free_pnm() in a basic case
@@ -48,6 +132,29 @@ static void test_fixture(void);
  */
 static void all_tests(void);
 
+/**
+ * \fn static void full_output(int redirect)
+ * @brief Point the standard output on a full device, where every write fails (redirect), or back where it was (!redirect)
+ */
+static void full_output(int redirect)
+{
+  static int saved = -1;
+  fflush(stdout);
+  if (redirect)
+  {
+    int full = open("/dev/full", O_WRONLY);
+    saved = dup(STDOUT_FILENO);
+    dup2(full, STDOUT_FILENO);
+    close(full);
+  }
+  else
+  {
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    clearerr(stdout);
+  }
+} // end full_output()
+
 static void test_load_pnm(void)
 {
   PNM *imageStruct;
@@ -62,8 +169,73 @@ static void test_load_pnm(void)
 
   assert_int_equal(0, load_pnm(&imageStruct, "img/pnm_tests/commentBtMatrixLines.ppm"));
   free_pnm(&imageStruct);
+
+  assert_int_equal(0, load_pnm(&imageStruct, "img/pnm_tests/commentEndOfLine.ppm"));
+  free_pnm(&imageStruct);
+
+  assert_true(freopen("img/pnm_tests/correct_binary.pgm", "rb", stdin) != NULL);
+  assert_int_equal(0, load_pnm(&imageStruct, "-"));
+  assert_int_equal(15, get_samples_count(imageStruct));
+  free_pnm(&imageStruct);
 } // test_load_pnm()
 
+static void test_load_pnm_parallel(void)
+{
+  FILE *image = fopen("parallel.ppm", "w");
+  FILE *truncated = fopen("parallel_truncated.ppm", "w");
+  fprintf(image, "P3\n400 300\n255 # max color value\n");
+  fprintf(truncated, "P3\n400 300\n255\n");
+  for (unsigned int i = 0; i < 400 * 300 * 3; i++)
+  {
+    unsigned int value = i == 300000 ? 1000 : (i * 7919) % 256;
+    if (i % 97 == 0)
+    {
+      fprintf(image, "%u# a comment at the end of a line\n", value);
+    }
+    else
+    {
+      fprintf(image, i % 17 == 16 ? "%u\n" : "%u ", value);
+    }
+    if (i % 50 == 0)
+    {
+      fprintf(image, "# a comment with numbers 12 34 and a # inside\n");
+    }
+    if (i < 400 * 300 * 2)
+    {
+      fprintf(truncated, "%u\n", value);
+    }
+  }
+  fclose(image);
+  fclose(truncated);
+
+  PNM *expected;
+  assert_int_equal(0, load_pnm(&expected, "parallel.ppm"));
+  for (unsigned int threadsCount = 1; threadsCount <= 4; threadsCount++)
+  {
+    PNM *imageStruct;
+    assert_int_equal(0, load_pnm_parallel(&imageStruct, "parallel.ppm", threadsCount));
+    assert_true(get_samples_count(imageStruct) == get_samples_count(expected));
+    int same = 1;
+    for (unsigned int line = 0; line < 300; line++)
+    {
+      for (unsigned int sample = 0; sample < 400 * 3; sample++)
+      {
+        same = same && get_sample(imageStruct, line, sample) == get_sample(expected, line, sample);
+      }
+    }
+    assert_true(same);
+    assert_int_equal(1000, get_sample(imageStruct, 250, 0));
+    free_pnm(&imageStruct);
+
+    assert_int_equal(-3, load_pnm_parallel(&imageStruct, "parallel_truncated.ppm", threadsCount));
+    assert_int_equal(0, load_pnm_parallel(&imageStruct, "img/pnm_tests/commentBtMatrixLines.ppm", threadsCount));
+    free_pnm(&imageStruct);
+  }
+  free_pnm(&expected);
+  remove("parallel.ppm");
+  remove("parallel_truncated.ppm");
+} // end test_load_pnm_parallel()
+
 static void test_write_pnm(void)
 {
   PNM *imageStruct;
@@ -71,10 +243,478 @@ static void test_write_pnm(void)
 
   assert_int_equal(-1, write_pnm(imageStruct, "../badPath.ppm"));
   assert_int_equal(0, write_pnm(imageStruct, "goodPath.ppm"));
+  full_output(1);
+  int status = write_pnm(imageStruct, "-");
+  full_output(0);
+  assert_int_equal(-2, status);
 
   free_pnm(&imageStruct);
 } // end test_write_pnm()
 
+static void test_get_sample(void)
+{
+  unsigned int expectedFirstSamples[6] = {1, 2, 3, 4, 4, 5};
+  PNM *imageStruct;
+  load_pnm(&imageStruct, "img/pnm_tests/correct.ppm");
+
+  for (unsigned int i = 0; i < 6; i++)
+  {
+    assert_int_equal(expectedFirstSamples[i], get_sample(imageStruct, 0, i));
+  }
+  assert_int_equal(0, get_sample(imageStruct, 511, 1535));
+
+  free_pnm(&imageStruct);
+} // end test_get_sample()
+
+static void test_encryption_round_trip(void)
+{
+  PNM *original;
+  PNM *imageStruct;
+  LFSR *lfsr = create_lfsr("0110100001011101", 5);
+  load_pnm(&original, "img/pnm_tests/correct.pbm");
+  load_pnm(&imageStruct, "img/pnm_tests/correct.pbm");
+  assert_int_equal(0, pnm_file_encryption(imageStruct, lfsr));
+  assert_int_equal(0, write_pnm(imageStruct, "encrypted.pbm"));
+  free_pnm(&imageStruct);
+  free_lfsr(&lfsr);
+
+  lfsr = create_lfsr("0110100001011101", 5);
+  assert_int_equal(0, load_pnm(&imageStruct, "encrypted.pbm"));
+  assert_true(get_sample(imageStruct, 0, 0) > 1);
+  assert_int_equal(0, pnm_file_encryption(imageStruct, lfsr));
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    for (unsigned int j = 0; j < 10; j++)
+    {
+      assert_int_equal(get_sample(original, i, j), get_sample(imageStruct, i, j));
+    }
+  }
+  free_pnm(&imageStruct);
+  free_pnm(&original);
+  free_lfsr(&lfsr);
+  remove("encrypted.pbm");
+} // end test_encryption_round_trip()
+
+/**
+ * \fn static int same_files(char *first, char *second)
+ * @brief Compare the content of two files
+ *
+ * \return int 1 if the files are identical, 0 otherwise
+ */
+static int same_files(char *first, char *second)
+{
+  FILE *a = fopen(first, "rb");
+  FILE *b = fopen(second, "rb");
+  int same = a && b;
+  while (same)
+  {
+    int ca = getc(a);
+    int cb = getc(b);
+    same = ca == cb;
+    if (ca == EOF)
+    {
+      break;
+    }
+  }
+  if (a)
+    fclose(a);
+  if (b)
+    fclose(b);
+  return same;
+} // end same_files()
+
+static void test_binary_pnm(void)
+{
+  char *files[3] = {"img/pnm_tests/correct_binary.pbm", "img/pnm_tests/correct_binary.pgm", "img/pnm_tests/correct_binary.ppm"};
+  char *copies[3] = {"binary.pbm", "binary.pgm", "binary.ppm"};
+  char *encrypted[3] = {"binaryEncrypted.pbm", "binaryEncrypted.pgm", "binaryEncrypted.ppm"};
+  PNM *imageStruct;
+  LFSR *lfsr;
+
+  assert_int_equal(0, load_pnm(&imageStruct, files[0]));
+  assert_int_equal(1, get_sample(imageStruct, 0, 0));
+  assert_int_equal(0, get_sample(imageStruct, 0, 1));
+  assert_int_equal(1, get_sample(imageStruct, 1, 9));
+  free_pnm(&imageStruct);
+  assert_int_equal(0, load_pnm(&imageStruct, files[1]));
+  assert_int_equal(140, get_sample(imageStruct, 2, 4));
+  free_pnm(&imageStruct);
+  assert_int_equal(0, load_pnm(&imageStruct, files[2]));
+  assert_int_equal(41 * 13, get_sample(imageStruct, 1, 1));
+  free_pnm(&imageStruct);
+
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    load_pnm(&imageStruct, files[i]);
+    assert_int_equal(0, write_pnm(imageStruct, copies[i]));
+    assert_true(same_files(files[i], copies[i]));
+
+    lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(0, pnm_file_encryption(imageStruct, lfsr));
+    write_pnm(imageStruct, encrypted[i]);
+    assert_true(!same_files(files[i], encrypted[i]));
+    free_pnm(&imageStruct);
+    free_lfsr(&lfsr);
+
+    lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(0, load_pnm(&imageStruct, encrypted[i]));
+    pnm_file_encryption(imageStruct, lfsr);
+    write_pnm(imageStruct, copies[i]);
+    assert_true(same_files(files[i], copies[i]));
+    free_pnm(&imageStruct);
+    free_lfsr(&lfsr);
+
+    remove(copies[i]);
+    remove(encrypted[i]);
+  }
+} // end test_binary_pnm()
+
+static void test_pnm_file_encryption_parallel(void)
+{
+  unsigned int threadsCounts[4] = {2, 3, 8, 1000};
+  PNM *imageStruct;
+  LFSR *lfsr = create_lfsr("0110100001011101", 5);
+  load_pnm(&imageStruct, "img/pnm_tests/correct.ppm");
+  pnm_file_encryption(imageStruct, lfsr);
+  write_pnm(imageStruct, "sequential.ppm");
+  free_pnm(&imageStruct);
+  unsigned int expected = generation(lfsr, 32);
+  free_lfsr(&lfsr);
+
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    lfsr = create_lfsr("0110100001011101", 5);
+    load_pnm(&imageStruct, "img/pnm_tests/correct.ppm");
+    pnm_file_encryption_parallel(imageStruct, lfsr, threadsCounts[i]);
+    write_pnm(imageStruct, "parallel.ppm");
+    assert_true(same_files("sequential.ppm", "parallel.ppm"));
+    assert_true(expected == generation(lfsr, 32));
+    free_pnm(&imageStruct);
+    free_lfsr(&lfsr);
+  }
+  remove("sequential.ppm");
+  remove("parallel.ppm");
+} // end test_pnm_file_encryption_parallel()
+
+static void test_pnm_file_encryption_stream(void)
+{
+  char *files[5] = {"img/pnm_tests/correct.pbm", "img/pnm_tests/correct.ppm", "img/pnm_tests/correct_binary.pbm", "img/pnm_tests/correct_binary.pgm", "img/pnm_tests/correct_binary.ppm"};
+  char *streamed[5] = {"streamed.pbm", "streamed.ppm", "streamed.pbm", "streamed.pgm", "streamed.ppm"};
+  char *loaded[5] = {"loaded.pbm", "loaded.ppm", "loaded.pbm", "loaded.pgm", "loaded.ppm"};
+  PNM *imageStruct;
+
+  for (unsigned int i = 0; i < 5; i++)
+  {
+    LFSR *lfsr = create_lfsr("0110100001011101", 5);
+    load_pnm(&imageStruct, files[i]);
+    pnm_file_encryption(imageStruct, lfsr);
+    write_pnm(imageStruct, loaded[i]);
+    free_pnm(&imageStruct);
+    unsigned int expected = generation(lfsr, 32);
+    free_lfsr(&lfsr);
+
+    lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(0, pnm_file_encryption_stream(files[i], streamed[i], lfsr, i % 2 ? 2 : 0));
+    assert_true(expected == generation(lfsr, 32));
+    free_lfsr(&lfsr);
+
+    // only the padding of the max color value of a P3 differs, it is gone once the file is loaded and written again
+    if (i == 1)
+    {
+      load_pnm(&imageStruct, streamed[i]);
+      write_pnm(imageStruct, streamed[i]);
+      free_pnm(&imageStruct);
+    }
+    assert_true(same_files(loaded[i], streamed[i]));
+    remove(loaded[i]);
+    remove(streamed[i]);
+  }
+
+  LFSR *lfsr = create_lfsr("0110100001011101", 5);
+  assert_int_equal(-3, pnm_file_encryption_stream("img/pnm_tests/missPixels.ppm", "streamed.ppm", lfsr, 0));
+  assert_true(fopen("streamed.ppm", "r") == NULL);
+  assert_int_equal(-3, pnm_file_encryption_stream("img/pnm_tests/missPixels.ppm", "streamed.ppm", lfsr, 2));
+  assert_true(fopen("streamed.ppm", "r") == NULL);
+  assert_int_equal(-2, pnm_file_encryption_stream("img/pnm_tests/incorrectExtension.pgm", "streamed.pgm", lfsr, 0));
+  for (unsigned int depth = 0; depth <= 2; depth += 2)
+  {
+    full_output(1);
+    int status = pnm_file_encryption_stream("img/pnm_tests/correct.ppm", "-", lfsr, depth);
+    full_output(0);
+    assert_int_equal(-4, status);
+  }
+  free_lfsr(&lfsr);
+} // end test_pnm_file_encryption_stream()
+
+static void test_pnm_file_encryption_pipeline(void)
+{
+  char *outputs[3] = {"sequential.pgm", "pipeline_1.pgm", "pipeline_3.pgm"};
+  unsigned int depths[3] = {0, 1, 3};
+
+  // an image of many bands, then the same image cut in the middle
+  FILE *image = fopen("pipeline.pgm", "w");
+  FILE *truncated = fopen("truncated.pgm", "w");
+  fprintf(image, "P2\n300 600\n65535\n");
+  fprintf(truncated, "P2\n300 600\n65535\n");
+  for (unsigned int i = 0; i < 300 * 600; i++)
+  {
+    fprintf(image, "%u ", (i * 7919) % 65536);
+    if (i < 300 * 400)
+    {
+      fprintf(truncated, "%u ", (i * 7919) % 65536);
+    }
+  }
+  fclose(image);
+  fclose(truncated);
+
+  for (unsigned int d = 0; d < 3; d++)
+  {
+    LFSR *lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(0, pnm_file_encryption_stream("pipeline.pgm", outputs[d], lfsr, depths[d]));
+    assert_true(same_files(outputs[0], outputs[d]));
+    assert_int_equal(-3, pnm_file_encryption_stream("truncated.pgm", "truncated_output.pgm", lfsr, depths[d]));
+    assert_true(fopen("truncated_output.pgm", "r") == NULL);
+    free_lfsr(&lfsr);
+  }
+  for (unsigned int d = 0; d < 3; d++)
+  {
+    remove(outputs[d]);
+  }
+  remove("pipeline.pgm");
+  remove("truncated.pgm");
+} // end test_pnm_file_encryption_pipeline()
+
+static void test_write_pnm_parallel(void)
+{
+  // a large bitmap and a large binary graymap of 16 bits samples, next to the bytes of correct.ppm
+  FILE *bitmap = fopen("parallel_input.pbm", "w");
+  fprintf(bitmap, "P1\n1000 300\n");
+  for (unsigned int i = 0; i < 1000 * 300; i++)
+  {
+    fprintf(bitmap, "%u ", (i * 7919) % 3 == 0);
+  }
+  fclose(bitmap);
+  FILE *graymap = fopen("parallel_input.pgm", "wb");
+  fprintf(graymap, "P5\n600 400\n65535\n");
+  for (unsigned int i = 0; i < 600 * 400; i++)
+  {
+    fputc((i * 7919) >> 8 & 0xFF, graymap);
+    fputc((i * 7919) & 0xFF, graymap);
+  }
+  fclose(graymap);
+
+  char *inputs[4] = {"img/pnm_tests/correct.ppm", "parallel_input.pbm", "parallel_input.pgm", "img/pnm_tests/correct.pbm"};
+  char *sequential[4] = {"sequential.ppm", "sequential.pbm", "sequential.pgm", "sequential_small.pbm"};
+  char *parallel[4] = {"parallel.ppm", "parallel.pbm", "parallel.pgm", "parallel_small.pbm"};
+  for (unsigned int k = 0; k < 4; k++)
+  {
+    PNM *imageStruct;
+    assert_int_equal(0, load_pnm(&imageStruct, inputs[k]));
+    assert_int_equal(-1, write_pnm_parallel(imageStruct, "../badPath.ppm", 2));
+    for (unsigned int encrypted = 0; encrypted < 2; encrypted++)
+    {
+      // the encryption turns the samples to 16 bits
+      if (encrypted)
+      {
+        LFSR *lfsr = create_lfsr("0110100001011101", 5);
+        pnm_file_encryption(imageStruct, lfsr);
+        free_lfsr(&lfsr);
+      }
+      assert_int_equal(0, write_pnm(imageStruct, sequential[k]));
+      for (unsigned int threadsCount = 1; threadsCount <= 4; threadsCount++)
+      {
+        assert_int_equal(0, write_pnm_parallel(imageStruct, parallel[k], threadsCount));
+        assert_true(same_files(sequential[k], parallel[k]));
+      }
+    }
+    free_pnm(&imageStruct);
+    remove(sequential[k]);
+    remove(parallel[k]);
+  }
+  remove("parallel_input.pbm");
+  remove("parallel_input.pgm");
+
+  // every block fails to be written past a limit of the file size
+  PNM *imageStruct;
+  struct rlimit saved;
+  struct rlimit limited;
+  assert_int_equal(0, load_pnm(&imageStruct, "img/pnm_tests/correct.ppm"));
+  getrlimit(RLIMIT_FSIZE, &saved);
+  limited = saved;
+  limited.rlim_cur = 4096;
+  signal(SIGXFSZ, SIG_IGN);
+  setrlimit(RLIMIT_FSIZE, &limited);
+  int status = write_pnm_parallel(imageStruct, "limited.ppm", 4);
+  setrlimit(RLIMIT_FSIZE, &saved);
+  signal(SIGXFSZ, SIG_DFL);
+  assert_int_equal(-2, status);
+  free_pnm(&imageStruct);
+  remove("limited.ppm");
+} // end test_write_pnm_parallel()
+
+static void test_pnm_file_crop(void)
+{
+  char *inputs[2] = {"img/pnm_tests/correct.ppm", "img/pnm_tests/correct_binary.ppm"};
+  char *encrypted[2] = {"crop_source.ppm", "crop_source_binary.ppm"};
+  unsigned int rectangles[2][4] = {{100, 200, 37, 50}, {1, 0, 3, 2}};
+  for (unsigned int k = 0; k < 2; k++)
+  {
+    PNM *original;
+    PNM *tile;
+    assert_int_equal(0, load_pnm(&original, inputs[k]));
+    LFSR *lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(0, load_pnm(&tile, inputs[k]));
+    pnm_file_encryption(tile, lfsr);
+    write_pnm(tile, encrypted[k]);
+    free_pnm(&tile);
+    free_lfsr(&lfsr);
+
+    unsigned int *rectangle = rectangles[k];
+    lfsr = create_lfsr("0110100001011101", 5);
+    size_t samples = 0;
+    assert_int_equal(0, pnm_file_crop(encrypted[k], "crop_tile.ppm", lfsr, rectangle[0], rectangle[1], rectangle[2], rectangle[3], &samples));
+    free_lfsr(&lfsr);
+    assert_true(samples == (size_t)rectangle[2] * rectangle[3] * 3);
+    assert_int_equal(0, load_pnm(&tile, "crop_tile.ppm"));
+    assert_true(get_samples_count(tile) == (size_t)rectangle[2] * rectangle[3] * 3);
+    int same = 1;
+    for (unsigned int line = 0; line < rectangle[3]; line++)
+    {
+      for (unsigned int sample = 0; sample < rectangle[2] * 3; sample++)
+      {
+        same = same && get_sample(tile, line, sample) == get_sample(original, rectangle[1] + line, rectangle[0] * 3 + sample);
+      }
+    }
+    assert_true(same);
+    free_pnm(&tile);
+    free_pnm(&original);
+
+    lfsr = create_lfsr("0110100001011101", 5);
+    assert_int_equal(-5, pnm_file_crop(encrypted[k], "crop_tile.ppm", lfsr, rectangle[0], rectangle[1], rectangle[2] + 600, 1, NULL));
+    assert_int_equal(-5, pnm_file_crop(encrypted[k], "crop_tile.ppm", lfsr, 0, 0, 0, 1, NULL));
+    free_lfsr(&lfsr);
+    remove(encrypted[k]);
+    remove("crop_tile.ppm");
+  }
+} // end test_pnm_file_crop()
+
+/**
+ * \fn static int same_rows(PNM *rows, PNM *original, unsigned int firstLine, unsigned int count, unsigned int samplesPerLine)
+ * @brief Check that the lines of an image are lines of another one
+ */
+static int same_rows(PNM *rows, PNM *original, unsigned int firstLine, unsigned int count, unsigned int samplesPerLine)
+{
+  int same = get_samples_count(rows) == (size_t)count * samplesPerLine;
+  for (unsigned int line = 0; same && line < count; line++)
+  {
+    for (unsigned int sample = 0; sample < samplesPerLine; sample++)
+    {
+      same = same && get_sample(rows, line, sample) == get_sample(original, firstLine + line, sample);
+    }
+  }
+  return same;
+} // end same_rows()
+
+static void test_load_pnm_rows(void)
+{
+  PNM *original;
+  PNM *rows;
+  unsigned int ranges[4][2] = {{0, 1}, {7, 20}, {500, 12}, {511, 1}};
+  assert_int_equal(0, load_pnm(&original, "img/pnm_tests/correct.ppm"));
+
+  // the index holds one entry every step lines, the lines loaded are the same with it and without it (an image
+  // written without index removes the index of the previous one)
+  unsigned int steps[4] = {1, 0, 7, 0};
+  for (unsigned int k = 0; k < 4; k++)
+  {
+    assert_int_equal(0, write_pnm_indexed(original, "rows.ppm", 2, steps[k]));
+    FILE *index = fopen("rows.ppm.idx", "rb");
+    assert_true((index != NULL) == (steps[k] != 0));
+    if (index)
+    {
+      fseek(index, 0, SEEK_END);
+      assert_true(ftell(index) == 24 + 16 * ((512 + steps[k] - 1) / steps[k]));
+      fclose(index);
+    }
+    for (unsigned int r = 0; r < 4; r++)
+    {
+      assert_int_equal(0, load_pnm_rows(&rows, "rows.ppm", ranges[r][0], ranges[r][1]));
+      assert_true(same_rows(rows, original, ranges[r][0], ranges[r][1], 512 * 3));
+      free_pnm(&rows);
+    }
+  }
+  assert_int_equal(-5, load_pnm_rows(&rows, "rows.ppm", 512, 1));
+  assert_int_equal(-5, load_pnm_rows(&rows, "rows.ppm", 500, 13));
+  assert_int_equal(-5, load_pnm_rows(&rows, "rows.ppm", 0, 0));
+
+  // the first line overwritten with letters : only a jump over it reaches the lines below
+  assert_int_equal(0, write_pnm_indexed(original, "rows.ppm", 1, 1));
+  FILE *index = fopen("rows.ppm.idx", "rb");
+  unsigned char entries[32];
+  fseek(index, 24, SEEK_SET);
+  assert_int_equal(32, (int)fread(entries, 1, 32, index));
+  fclose(index);
+  long first = 0;
+  long second = 0;
+  for (int b = 7; b >= 0; b--)
+  {
+    first = first << 8 | entries[b];
+    second = second << 8 | entries[16 + b];
+  }
+  FILE *image = fopen("rows.ppm", "r+b");
+  fseek(image, first, SEEK_SET);
+  for (long b = first; b < second - 1; b++)
+  {
+    fputc('x', image);
+  }
+  fclose(image);
+  assert_int_equal(0, load_pnm_rows(&rows, "rows.ppm", 1, 3));
+  assert_true(same_rows(rows, original, 1, 3, 512 * 3));
+  free_pnm(&rows);
+  assert_int_equal(-3, load_pnm_rows(&rows, "rows.ppm", 0, 1));
+
+  // an index of another size of the image is ignored
+  image = fopen("rows.ppm", "ab");
+  fputc('\n', image);
+  fclose(image);
+  assert_int_equal(-3, load_pnm_rows(&rows, "rows.ppm", 1, 3));
+  remove("rows.ppm.idx");
+  assert_int_equal(-3, load_pnm_rows(&rows, "rows.ppm", 1, 3));
+  remove("rows.ppm");
+  free_pnm(&original);
+
+  // an index of another image of the same size : its offsets aren't at the beginning of the lines of this one
+  FILE *first_image = fopen("rows_first.pgm", "w");
+  fprintf(first_image, "P2\n2 4\n10\n10 1\n1 1\n1 1\n1 1\n");
+  fclose(first_image);
+  FILE *second_image = fopen("rows_second.pgm", "w");
+  fprintf(second_image, "P2\n2 4\n10\n1 1\n10 1\n1 1\n1 1\n");
+  fclose(second_image);
+  assert_int_equal(0, load_pnm(&original, "rows_first.pgm"));
+  assert_int_equal(0, write_pnm_indexed(original, "rows_swapped.pgm", 1, 1));
+  free_pnm(&original);
+  assert_int_equal(0, load_pnm(&original, "rows_second.pgm"));
+  assert_int_equal(0, write_pnm(original, "rows_second.pgm"));
+  assert_int_equal(0, rename("rows_second.pgm", "rows_swapped.pgm"));
+  assert_int_equal(0, load_pnm_rows(&rows, "rows_swapped.pgm", 1, 1));
+  assert_true(same_rows(rows, original, 1, 1, 2));
+  free_pnm(&rows);
+  free_pnm(&original);
+  remove("rows_first.pgm");
+  remove("rows_swapped.pgm");
+  remove("rows_swapped.pgm.idx");
+
+  // the lines of a binary image are at fixed offsets, no index is written
+  assert_int_equal(0, load_pnm(&original, "img/pnm_tests/correct_binary.ppm"));
+  assert_int_equal(0, write_pnm_indexed(original, "rows_binary.ppm", 1, 1));
+  assert_true(fopen("rows_binary.ppm.idx", "rb") == NULL);
+  assert_int_equal(0, load_pnm_rows(&rows, "rows_binary.ppm", 1, 1));
+  assert_true(same_rows(rows, original, 1, 1, get_samples_count(original) / 2));
+  free_pnm(&rows);
+  free_pnm(&original);
+  remove("rows_binary.ppm");
+} // end test_load_pnm_rows()
+
 static void test_free_pnm(void)
 {
   PNM *imageStruct;
@@ -87,7 +727,17 @@ static void test_fixture(void)
 {
   test_fixture_start();
   run_test(test_load_pnm);
+  run_test(test_load_pnm_parallel);
   run_test(test_write_pnm);
+  run_test(test_write_pnm_parallel);
+  run_test(test_get_sample);
+  run_test(test_encryption_round_trip);
+  run_test(test_binary_pnm);
+  run_test(test_pnm_file_encryption_stream);
+  run_test(test_pnm_file_encryption_pipeline);
+  run_test(test_pnm_file_encryption_parallel);
+  run_test(test_pnm_file_crop);
+  run_test(test_load_pnm_rows);
   run_test(test_free_pnm);
   test_fixture_end();
 } // end test_fixture()
@@ -35,6 +35,12 @@ static void test_get_file_extension(void);
  */
 static void test_check_file_name(void);
 
+/**
+ * \fn static void test_is_standard_stream()
+ * @brief Test is_standard_stream() for "-" and for a file name
+ */
+static void test_is_standard_stream(void);
+
 /**
  * \fn static void test_fixture()
  * @brief Run the test routine
@@ -49,8 +55,12 @@ static void all_tests(void);
 
 static void test_create_matrix(void)
 {
-    unsigned int **matrix = create_matrix(5, 10);
+    size_t stride;
+    unsigned char *matrix = create_matrix(5, 10, &stride);
     assert_true(matrix != NULL);
+    assert_true(stride >= 10);
+    assert_true((size_t)matrix % 64 == 0 && stride % 64 == 0);
+    free_matrix(matrix);
 } // end test_create_matrix()
 
 static void test_base64_string_to_binary_string(void)
@@ -88,6 +98,13 @@ static void test_check_file_name(void)
     assert_true(!check_file_name(containFordidChar));
 } // end test_check_file_name()
 
+static void test_is_standard_stream(void)
+{
+    assert_true(is_standard_stream("-"));
+    assert_true(!is_standard_stream("-.pgm"));
+    assert_true(!is_standard_stream("img.pgm"));
+} // end test_is_standard_stream()
+
 static void test_fixture(void)
 {
     test_fixture_start();
@@ -95,6 +112,7 @@ static void test_fixture(void)
     run_test(test_base64_string_to_binary_string);
     run_test(test_get_file_extension);
     run_test(test_check_file_name);
+    run_test(test_is_standard_stream);
     test_fixture_end();
 } // end test_fixture()
 
@@ -6,6 +6,8 @@
  * \version: V2
  */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -18,46 +20,38 @@
  */
 #define BASE64_CHAR_BINARY_SIZE 6
 
+/**
+ * \def MATRIX_ALIGNMENT
+ * The alignment (in bytes) of a matrix and of each of its lines.
+ */
+#define MATRIX_ALIGNMENT 64
+
 const char *forbidenCharactersInFiles = "/\\:*?\"<>|";
 const char *BASE64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-unsigned int **create_matrix(unsigned int matrix_len, unsigned int row_len)
+/**
+ * The stream of the messages, NULL for the standard output (which isn't a constant expression).
+ */
+static FILE *messagesStream = NULL;
+
+unsigned char *create_matrix(unsigned int matrix_len, size_t row_len, size_t *stride)
 {
-    assert(matrix_len > 0 && row_len > 0);
-    unsigned int **matrix;
+    assert(matrix_len > 0 && row_len > 0 && stride);
+    void *matrix;
 
-    if (!(matrix = malloc(sizeof(int *) * matrix_len)))
+    *stride = (row_len + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+    if (posix_memalign(&matrix, MATRIX_ALIGNMENT, (size_t)matrix_len * *stride) != 0)
     {
         return NULL;
     }
 
-    for (unsigned i = 0; i < matrix_len; i++)
-    {
-        matrix[i] = malloc(row_len * sizeof(unsigned int));
-        if (!matrix[i])
-        {
-            for (unsigned j = 0; j < i; j++)
-            {
-                free(matrix[j]);
-            }
-            free(matrix[i]);
-            return NULL;
-        }
-    }
-
     return matrix;
 } // end create_matrix()
 
-void free_matrix(unsigned int **m, unsigned int lines)
+void free_matrix(unsigned char *m)
 {
     assert(m);
-    for (unsigned i = 0; i < lines; i++)
-    {
-        free(m[i]);
-        m[i] = NULL;
-    }
     free(m);
-    m = NULL;
 } // end free_matrix()
 
 char *base64_string_to_binary_string(char *string)
@@ -70,13 +64,14 @@ char *base64_string_to_binary_string(char *string)
         return NULL;
     }
     toBinaryString[(BASE64_CHAR_BINARY_SIZE + 1) * strlen(string)] = '\0';
+    toBinaryString[0] = '\0';
 
     for (unsigned int i = 0; i < strlen(string); i++)
     {
         char *indexInBase64 = strchr(BASE64, string[i]);
         if (!indexInBase64)
         {
-            printf("> 🔴 The character [%c] isn't allowed. Please use only these : [%s].\n", string[i], BASE64);
+            fprintf(get_messages_stream(), "> 🔴 The character [%c] isn't allowed. Please use only these : [%s].\n", string[i], BASE64);
             return NULL;
         }
 
@@ -115,7 +110,7 @@ char *get_file_extension(char *fileName)
     char *extension;
     if (!(extension = strrchr(fileName, '.')))
     {
-        printf("> 🔴 The file name [%s] does not contain an extension.\n", fileName);
+        fprintf(get_messages_stream(), "> 🔴 The file name [%s] does not contain an extension.\n", fileName);
         return NULL;
     }
     extension++;
@@ -139,7 +134,7 @@ int check_file_name(char *fileName)
             }
             else
             {
-                printf("> 🔴 The file name [%s] contain more than one [.] character (wich shouldn't happen).\n", fileName);
+                fprintf(get_messages_stream(), "> 🔴 The file name [%s] contain more than one [.] character (wich shouldn't happen).\n", fileName);
                 return 0;
             }
         }
@@ -148,10 +143,27 @@ int check_file_name(char *fileName)
         {
             if (fileName[i] == forbidenCharactersInFiles[j])
             {
-                printf("> 🔴 The file name [%s] contain at least a forbiden character : [%c].\n", fileName, forbidenCharactersInFiles[j]);
+                fprintf(get_messages_stream(), "> 🔴 The file name [%s] contain at least a forbiden character : [%c].\n", fileName, forbidenCharactersInFiles[j]);
                 return 0;
             }
         }
     }
     return 1;
 } // end check_file_name()
+
+int is_standard_stream(char *fileName)
+{
+    assert(fileName != NULL);
+    return strcmp(fileName, "-") == 0;
+} // end is_standard_stream()
+
+FILE *get_messages_stream(void)
+{
+    return messagesStream ? messagesStream : stdout;
+} // end get_messages_stream()
+
+void set_messages_stream(FILE *stream)
+{
+    assert(stream != NULL);
+    messagesStream = stream;
+} // end set_messages_stream()
\ No newline at end of file
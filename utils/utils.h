@@ -1,9 +1,10 @@
 /**
  * \file utils.h
  * \brief This file contains type declarations and prototypes of functions for :
- *          - allocation / release of int matrixes
- *          - checking file names
+ *          - allocation / release of matrixes
+ *          - checking file names (and the "-" of the standard streams)
  *          - conversion of char from base64 to binary
+ *          - the stream of the messages
  * \author Gardier Simon
  * \date 26.10.2023
  * \version: V2
@@ -12,6 +13,9 @@
 #ifndef __UTILS__
 #define __UTILS__
 
+#include <stddef.h>
+#include <stdio.h>
+
 /**
  * The list of forbiden characters in an output file name.
  */
@@ -23,28 +27,29 @@ extern const char *forbidenCharactersInFiles;
 extern const char *BASE64;
 
 /**
- * \brief Create an int matrix of size n.
+ * \brief Create a byte matrix stored in a single aligned buffer.
  *
  * \param n The number of lines.
- * \param m The number of columns.
+ * \param m The number of bytes in a line.
+ * \param stride The address where to write the number of bytes between the beginnings of two lines.
  *
- * \pre n>0, m>0
- * \post A matrix of unsigned ints is return.
+ * \pre n>0, m>0, stride is instanced.
+ * \post A matrix of bytes is return, line i begins at index i * (*stride), *stride >= m.
  *
- * \return unsigned int** The matrix created.
+ * \return unsigned char* The matrix created.
+ *                        NULL in case of error.
  */
-unsigned int **create_matrix(unsigned int n, unsigned int m);
+unsigned char *create_matrix(unsigned int n, size_t m, size_t *stride);
 
 /**
- * \brief Free an int matrix of size n.
+ * \brief Free a matrix created by create_matrix().
  *
  * \param m The matrix to free.
- * \param lines The number of lines
  *
  * \pre m is instanced
  * \post Memory space occupied by the matrix is frees.
  */
-void free_matrix(unsigned int **m, unsigned int lines);
+void free_matrix(unsigned char *m);
 
 /**
  * \brief Convert a string made of base 64 characters in a string containing the binary representation of each character.
@@ -84,4 +89,35 @@ char *get_file_extension(char *fileName);
  */
 int check_file_name(char *fileName);
 
+/**
+ * \brief Check if a file name designates the standard input or output ("-").
+ *
+ * \param fileName The file name.
+ *
+ * \pre fileName is instanced.
+ * \post The file name has been checked.
+ *
+ * \return int 1 The file name is "-"
+ *              0 Otherwise
+ */
+int is_standard_stream(char *fileName);
+
+/**
+ * \brief Get the stream where the libraries and the program print their messages.
+ *
+ * \return FILE* The stream given to set_messages_stream(), the standard output by default.
+ */
+FILE *get_messages_stream(void);
+
+/**
+ * \brief Set the stream where the libraries and the program print their messages, the standard error when the
+ *        standard output carries an image.
+ *
+ * \param stream The stream.
+ *
+ * \pre stream is instanced, no other thread prints a message.
+ * \post The next messages are printed on stream.
+ */
+void set_messages_stream(FILE *stream);
+
 #endif //__UTILS__